@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+
+# Checks that the hand-written scanners in src/syntaxhighlighter.cpp find the
+# same matches as the regular expressions they replaced.
+#
+# The scan namespace is extracted from the source, compiled together with the
+# original std::wregex patterns into a small standalone program and both are
+# run on random strings made of characters significant to the syntax. Match
+# ranges are compared the way SyntaxHighlighter reports them.
+#
+# Usage: scripts/check-syntaxhighlighter-scanners.py [ITERATIONS] [SEED]
+#
+# Set CXX to use a compiler other than c++.
+
+import os
+import os.path
+import subprocess
+import sys
+from tempfile import TemporaryDirectory
+
+
+SOURCE = os.path.join(os.path.dirname(__file__), '..', 'src', 'syntaxhighlighter.cpp')
+
+SCAN_BEGIN = 'namespace scan\n{'
+SCAN_END = '} // namespace scan'
+
+# (name, triggers, scanner, original regex)
+CHECKS = [
+    ('html', '<&', 'html_markup',
+        r'''(<\/?[a-zA-Z0-9:-]+(\s+[-:\w]+(=([-:\w+]|"[^"]*"|'[^']*'))?)*\s*\/?>)|(&[^ ;]+;)'''),
+    ('common', '{%', 'common_placeholders',
+        r'''%[\w.-]+%|%?\{[\w.-]+\}|\{\{[\w.-]+\}\}'''),
+    ('dollars', '$', 'dollar_placeholders',
+        r'''\$[A-Za-z0-9_]+\$'''),
+    ('php', '%', 'php_format',
+        r'''%(\d+\$)?[-+]{0,2}([ 0]|'.)?-?\d*(\..?\d+)?[%bcdeEfFgGosuxX]'''),
+    ('c', '%', 'c_format<wchar_t, true>',
+        r'''%(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?((hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp]|<[A-Za-z0-9]+>)'''),
+    ('objc', '%', 'objc_format',
+        r'''%@|%(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?((hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp]|<[A-Za-z0-9]+>)'''),
+    ('c++', '{}', 'cxx20_or_rust_format',
+        r'''(\{\{)|(\}\})|(\{[^}]*\})'''),
+    ('python', '%{', 'python_format',
+        r'''(%(\(\w+\))?[-+ #0]?(\d+|\*)?(\.(\d+|\*))?[hlL]?[diouxXeEfFgGcrs%])|\{[\w.-:,]+\}'''),
+    ('ruby', '%', 'c_format<wchar_t, false>',
+        r'''%(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?(hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp]'''),
+    ('qt', '%', 'qt_format',
+        r'''%L?(\d\d?|n)'''),
+    ('lua', '%', 'lua_format',
+        r'''%[- 0]*\d*(\.\d+)?[sqdiouXxAaEefGgc]'''),
+    ('braces', '{', 'braces_format',
+        r'''\{[\w.-:,]+\}'''),
+    ('pascal', '%', 'pascal_format',
+        r'''%(\*:|\d*:)?-?(\*|\d+)?(\.\*|\.\d+)?[dDuUxXeEfFgGnNmMsSpP]'''),
+    ('javascript', '%', 'javascript_format',
+        r'''%[%csbdioOxXfj]'''),
+    ('go', '%', 'go_format',
+        r'''%[-+ #0]*(\d+|\*)?(\.(\d+|\*))?[vdoOxXbcqsptTeEfFgG%]'''),
+    ('d', '%', 'd_format',
+        r'''%(\d+\$)?[-+ #0=]*(\d+|\*)?(\.(\d+|\*))?([sdxXobfFeEgGaAc%]|\([^%]*(%[^%|)]*(%\|[^%)]*)?)%\))'''),
+]
+
+HARNESS = r'''
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+%(scan)s
+
+typedef std::vector<std::pair<size_t, size_t>> Matches;
+typedef size_t (*MatchFunc)(const wchar_t *p, const wchar_t *end);
+
+// what RegexSyntaxHighlighter used to report
+static bool regex_matches(const std::wregex& re, const std::wstring& s, Matches& out)
+{
+    try
+    {
+        for (std::wsregex_iterator i(s.begin(), s.end(), re), end; i != end; ++i)
+        {
+            if (!i->empty())
+                out.emplace_back(i->position(), i->length());
+        }
+        return true;
+    }
+    catch (std::regex_error&)
+    {
+        return false; // the regex gave up, nothing to compare
+    }
+}
+
+// what ScannerSyntaxHighlighter reports
+static void scanner_matches(const char *triggers, MatchFunc match, const std::wstring& s, Matches& out)
+{
+    const wchar_t *begin = s.data();
+    const wchar_t *end = begin + s.length();
+    for (const wchar_t *p = begin; p < end; )
+    {
+        const auto code = static_cast<uint32_t>(*p);
+        if (code != 0 && code < 128 && std::strchr(triggers, (char)code))
+        {
+            if (auto len = match(p, end))
+            {
+                out.emplace_back(p - begin, len);
+                p += len;
+                continue;
+            }
+        }
+        ++p;
+    }
+}
+
+struct Check
+{
+    const char *name;
+    const char *triggers;
+    MatchFunc match;
+    const wchar_t *regex;
+};
+
+static const Check CHECKS[] = {
+%(checks)s
+};
+
+// characters significant to any of the patterns, plus a few that aren't
+static const wchar_t ALPHABET[] =
+    L"%%%%%%%%{{{{}}}}<<>>&&;;$$::,,..--++**##==()|@/\\\"'_ \t\n\r"
+    L"0123456789hljztLdiouxXeEfFgGcrsnpqvbTSaAOmMNPUDj"
+    L"é  ";
+
+int main(int argc, char **argv)
+{
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 100000;
+    std::mt19937 rng(argc > 2 ? std::atoi(argv[2]) : 1);
+    std::uniform_int_distribution<size_t> length_dist(0, 40);
+    std::uniform_int_distribution<size_t> char_dist(0, sizeof(ALPHABET) / sizeof(ALPHABET[0]) - 2);
+
+    int failures = 0;
+    for (auto& check: CHECKS)
+    {
+        const std::wregex re(check.regex, std::regex_constants::ECMAScript | std::regex_constants::optimize);
+        long compared = 0;
+        for (long n = 0; n < iterations; ++n)
+        {
+            std::wstring s(length_dist(rng), L' ');
+            for (auto& c: s)
+                c = ALPHABET[char_dist(rng)];
+
+            Matches expected, actual;
+            if (!regex_matches(re, s, expected))
+                continue;
+            scanner_matches(check.triggers, check.match, s, actual);
+            compared++;
+
+            if (expected != actual)
+            {
+                std::printf("%%s: mismatch for \"%%ls\"\n", check.name, s.c_str());
+                for (auto& m: expected)
+                    std::printf("    regex:   %%zu+%%zu\n", m.first, m.second);
+                for (auto& m: actual)
+                    std::printf("    scanner: %%zu+%%zu\n", m.first, m.second);
+                failures++;
+                break;
+            }
+        }
+        std::printf("%%-12s %%ld strings compared\n", check.name, compared);
+    }
+
+    return failures ? 1 : 0;
+}
+'''
+
+
+def extract_scanners(source):
+    begin = source.index(SCAN_BEGIN)
+    end = source.index(SCAN_END, begin) + len(SCAN_END)
+    return source[begin:end]
+
+
+def cxx_string(s):
+    return 'L"' + s.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def main():
+    with open(SOURCE, encoding='utf-8') as f:
+        scan = extract_scanners(f.read())
+
+    checks = ',\n'.join('    { "%s", "%s", scan::%s%s, %s }' %
+                        (name, triggers, func, '' if '<' in func else '<wchar_t>', cxx_string(regex))
+                        for name, triggers, func, regex in CHECKS)
+
+    with TemporaryDirectory() as tmpdir:
+        src = os.path.join(tmpdir, 'check.cpp')
+        exe = os.path.join(tmpdir, 'check')
+        with open(src, 'w', encoding='utf-8') as f:
+            f.write(HARNESS % {'scan': scan, 'checks': checks})
+
+        cxx = os.environ.get('CXX', 'c++')
+        subprocess.run([cxx, '-std=c++17', '-O2', '-o', exe, src], check=True)
+        return subprocess.run([exe] + sys.argv[1:]).returncode
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -28,9 +28,9 @@
 #include "catalog_po.h"
 #include "concurrency.h"
 #include "progress.h"
+#include "str_helpers.h"
 
-#include <map>
-#include <set>
+#include <algorithm>
 
 
 namespace
@@ -41,25 +41,49 @@ inline MergeStats::Key make_key_full(const CatalogItemPtr& i)
     return {i->GetRawString(), i->GetRawPluralString(), i->GetContext(), i->GetRawSymbolicId()};
 }
 
-template<auto MakeKey = make_key_full, typename TFunc>
-inline void build_item_keys(CatalogPtr cat, TFunc&& f)
+/// 64bit fingerprint of the item's full key (see make_key_full)
+inline uint64_t fingerprint(const CatalogItemPtr& i)
 {
-    for (auto& i: cat->items())
-    {
-        f(MakeKey(i), i);
-    }
+    return str::hash64()
+           .add(i->GetRawString())
+           .add(i->GetRawPluralString())
+           .add(i->GetContext())
+           .add(i->GetRawSymbolicId())
+           .value();
 }
 
-template<auto MakeKey = make_key_full, typename T>
-inline void build_item_map(T& map, CatalogPtr cat)
+typedef std::vector<std::pair<uint64_t, CatalogItemPtr>> Fingerprints;
+
+/// Returns fingerprints of all items in @a cat, sorted and with duplicates removed.
+Fingerprints build_fingerprints(CatalogPtr cat)
 {
-    build_item_keys<MakeKey>(cat, [&](auto&& key, CatalogItemPtr i){ map.emplace(key, i); });
+    auto& items = cat->items();
+    Fingerprints out(items.size());
+    dispatch::parallel_for(items.size(), 1024, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            out[i] = {fingerprint(items[i]), items[i]};
+    });
+
+    auto less = [](const auto& a, const auto& b){ return a.first < b.first; };
+    dispatch::parallel_sort(out.begin(), out.end(), less);
+    out.erase(std::unique(out.begin(), out.end(), [](const auto& a, const auto& b){ return a.first == b.first; }),
+              out.end());
+    return out;
 }
 
-template<auto MakeKey = make_key_full, typename T>
-inline void build_item_set(T& map, CatalogPtr cat)
+/// Appends keys of items from @a a that are not in @a b to @a out.
+void diff_fingerprints(const Fingerprints& a, const Fingerprints& b, std::vector<MergeStats::Key>& out)
 {
-    build_item_keys<MakeKey>(cat, [&](auto&& key, CatalogItemPtr){ map.insert(key); });
+    auto ib = b.begin();
+    for (auto& i: a)
+    {
+        while (ib != b.end() && ib->first < i.first)
+            ++ib;
+        if (ib == b.end() || ib->first != i.first)
+            out.push_back(make_key_full(i.second));
+    }
+    std::sort(out.begin(), out.end());
 }
 
 } // anonymous namespace
@@ -72,35 +96,21 @@ void ComputeMergeStats(MergeStats& r, CatalogPtr po, CatalogPtr refcat)
     r.added.clear();
     r.removed.clear();
 
-    // First collect all strings from both sides, then diff the sets.
+    // Fingerprint all strings from both sides, then diff the (sorted) lists.
+    // Full keys are only constructed for the few strings that differ.
     // Run the two sides in parallel for speed up on large files.
 
-    std::set<MergeStats::Key> strsThis, strsRef;
+    Fingerprints strsThis, strsRef;
 
-    auto collect1 = dispatch::async([&]{ build_item_set(strsThis, po); });
-    auto collect2 = dispatch::async([&]{ build_item_set(strsRef, refcat); });
+    auto collect1 = dispatch::async([&]{ strsThis = build_fingerprints(po); });
+    auto collect2 = dispatch::async([&]{ strsRef = build_fingerprints(refcat); });
 
     collect1.get();
     collect2.get();
     progress.increment();
 
-    auto add1 = dispatch::async([&]
-    {
-        for (auto& i: strsThis)
-        {
-            if (strsRef.find(i) == strsRef.end())
-                r.removed.push_back(i);
-        }
-    });
-
-    auto add2 = dispatch::async([&]
-    {
-        for (auto& i: strsRef)
-        {
-            if (strsThis.find(i) == strsThis.end())
-                r.added.push_back(i);
-        }
-    });
+    auto add1 = dispatch::async([&]{ diff_fingerprints(strsThis, strsRef, r.removed); });
+    auto add2 = dispatch::async([&]{ diff_fingerprints(strsRef, strsThis, r.added); });
 
     add1.get();
     add2.get();
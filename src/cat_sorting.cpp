@@ -26,11 +26,14 @@
 
 #include "cat_sorting.h"
 
+#include "concurrency.h"
 #include "str_helpers.h"
 
 #include <wx/config.h>
 #include <wx/log.h>
 
+#include <mutex>
+
 
 /*static*/ SortOrder SortOrder::Default()
 {
@@ -79,6 +82,54 @@ void SortOrder::Save()
 }
 
 
+template<typename T>
+std::vector<CatalogItemsComparator::SortKey>
+CatalogItemsComparator::BuildSortKeys(T&& get)
+{
+    const size_t count = m_catalog.GetCount();
+    std::vector<SortKey> keys(count);
+
+    // Each chunk fills its own arena, they are concatenated at the end:
+    std::mutex mutex;
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> arenas;
+
+    dispatch::parallel_for(count, 1024, [&](size_t begin, size_t end)
+    {
+        std::vector<uint8_t> arena;
+        arena.reserve((end - begin) * 32);
+        for (size_t i = begin; i < end; i++)
+        {
+            auto s = get(Item((int)i));
+            const size_t offset = arena.size();
+            const size_t length = m_collator->append_sort_key(s, -1, arena);
+            keys[i] = {(uint32_t)offset, (uint32_t)length};
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        arenas.emplace_back(begin, std::move(arena));
+    });
+
+    std::sort(arenas.begin(), arenas.end(),
+              [](const auto& a, const auto& b){ return a.first < b.first; });
+
+    size_t total = m_keysArena.size();
+    for (auto& a: arenas)
+        total += a.second.size();
+    m_keysArena.reserve(total);
+
+    for (size_t n = 0; n < arenas.size(); n++)
+    {
+        const size_t end = (n + 1 < arenas.size()) ? arenas[n + 1].first : count;
+        const uint32_t base = (uint32_t)m_keysArena.size();
+        for (size_t i = arenas[n].first; i < end; i++)
+            keys[i].offset += base;
+        m_keysArena.insert(m_keysArena.end(), arenas[n].second.begin(), arenas[n].second.end());
+    }
+
+    return keys;
+}
+
+
 CatalogItemsComparator::CatalogItemsComparator(const Catalog& catalog, const SortOrder& order)
     : m_catalog(catalog), m_order(order)
 {
@@ -98,101 +149,114 @@ CatalogItemsComparator::CatalogItemsComparator(const Catalog& catalog, const Sor
             break;
     }
 
-    // Prepare cache for faster comparison. ICU uses UTF-16 internally, we can significantly
-    // speed up comparisons by doing string conversion in advance, in O(n) time and space, if
-    // the platform's native representation is UTF-32 or -8 (which it is on non-Windows).
-    // Moreover, the additional processing of removing accelerators is also done only once
-    // on all platforms, resulting in massive speedups on Windows too.
-    switch (m_order.by)
-    {
-        case SortOrder::By_Source:
-            m_sortKeys.reserve(m_catalog.GetCount());
-            for (auto& i: m_catalog.items())
-                m_sortKeys.push_back(ConvertToSortKey(i->GetString()));
-            break;
+    const int count = (int)m_catalog.GetCount();
+    m_prefix.resize(count);
+    for (int i = 0; i < count; i++)
+        m_prefix[i] = MakePrefix(Item(i));
 
-        case SortOrder::By_Translation:
-            m_sortKeys.reserve(m_catalog.GetCount());
-            for (auto& i: m_catalog.items())
-                m_sortKeys.push_back(ConvertToSortKey(i->GetTranslation()));
-            break;
+    // Comparing strings with the collator is expensive and std::sort() does it
+    // O(n log n) times, so compute binary sort keys instead, in O(n) time and
+    // space, and compare them with memcmp(). Additional processing of removing
+    // accelerators is also done only once.
+    if (m_order.groupByContext)
+        m_contextKeys = BuildSortKeys(&CatalogItemsComparator::ContextForKey);
 
-        case SortOrder::By_FileOrder:
-            break;
-    }
+    if (m_order.by != SortOrder::By_FileOrder)
+        m_textKeys = BuildSortKeys([this](const CatalogItem& item){ return TextForKey(item); });
 }
 
 
-bool CatalogItemsComparator::operator()(int i, int j) const
+uint8_t CatalogItemsComparator::MakePrefix(const CatalogItem& item) const
 {
-    const CatalogItem& a = Item(i);
-    const CatalogItem& b = Item(j);
+    // Flags-based criteria are packed into a single byte per item, most
+    // significant first, so that they can be compared in one go:
+    uint8_t p = 0;
 
     if ( m_order.errorsFirst )
     {
         // hard errors always go first:
-        if ( a.HasError() && !b.HasError() )
-            return true;
-        else if ( !a.HasError() && b.HasError() )
-            return false;
-
+        if ( !item.HasError() )
+            p |= 0x10;
         // warnings are more nuanced and should only be considered on non-fuzzy
         // entries (see https://github.com/vslavik/poedit/issues/611 for discussion):
-        auto const a_shouldWarn = a.HasIssue() && !a.IsFuzzy();
-        auto const b_shouldWarn = b.HasIssue() && !b.IsFuzzy();
-        if ( a_shouldWarn && !b_shouldWarn )
-            return true;
-        else if ( !a_shouldWarn && b_shouldWarn )
-            return false;
+        if ( !(item.HasIssue() && !item.IsFuzzy()) )
+            p |= 0x08;
     }
 
     if ( m_order.untransFirst )
     {
-        if ( !a.IsTranslated() && b.IsTranslated() )
-            return true;
-        else if ( a.IsTranslated() && !b.IsTranslated() )
-            return false;
-
-        if ( a.IsFuzzy() && !b.IsFuzzy() )
-            return true;
-        else if ( !a.IsFuzzy() && b.IsFuzzy() )
-            return false;
+        if ( item.IsTranslated() )
+            p |= 0x04;
+        if ( !item.IsFuzzy() )
+            p |= 0x02;
     }
 
-    if ( m_order.groupByContext )
-    {
-        if ( a.HasContext() && !b.HasContext() )
-            return true;
-        else if ( !a.HasContext() && b.HasContext() )
-            return false;
-        else if ( a.HasContext() && b.HasContext() )
-        {
-            // we don't want to apply translation string pre-processing to contexts, use collator directly
-            auto r = m_collator->compare(a.GetContext(), b.GetContext());
-            if ( r != 0 )
-                return r < 0;
-        }
-    }
+    if ( m_order.groupByContext && !item.HasContext() )
+        p |= 0x01;
+
+    return p;
+}
+
+
+/*static*/ str::UCharBuffer CatalogItemsComparator::ContextForKey(const CatalogItem& item)
+{
+    // we don't want to apply translation string pre-processing to contexts, use collator directly
+    if (!item.HasContext())
+        return str::UCharBuffer::null();
+    return str::to_icu(item.GetContext());
+}
 
-    switch ( m_order.by )
-    {
-        case SortOrder::By_FileOrder:
-        {
-            return i < j;
-        }
 
+str::UCharBuffer CatalogItemsComparator::TextForKey(const CatalogItem& item) const
+{
+    switch (m_order.by)
+    {
         case SortOrder::By_Source:
+            return ConvertToSortKey(item.GetString());
         case SortOrder::By_Translation:
-        {
-            auto r = m_collator->compare(m_sortKeys[i], m_sortKeys[j]);
-            if ( r != 0 )
-                return r < 0;
+            return ConvertToSortKey(item.GetTranslation());
+        case SortOrder::By_FileOrder:
             break;
-        }
+    }
+    return str::UCharBuffer::null();
+}
+
+
+bool CatalogItemsComparator::UpdateKey(SortKey& key, const UChar *s)
+{
+    const size_t offset = m_keysArena.size();
+    const size_t length = m_collator->append_sort_key(s, -1, m_keysArena);
+
+    if (length == key.length && memcmp(m_keysArena.data() + key.offset, m_keysArena.data() + offset, length) == 0)
+    {
+        m_keysArena.resize(offset);
+        return false;
+    }
+
+    // the old key is left unused in the arena until the next full sort
+    key = {(uint32_t)offset, (uint32_t)length};
+    return true;
+}
+
+
+bool CatalogItemsComparator::UpdateItem(int i, bool texts)
+{
+    bool changed = false;
+
+    const uint8_t p = MakePrefix(Item(i));
+    if (p != m_prefix[i])
+    {
+        m_prefix[i] = p;
+        changed = true;
+    }
+
+    if (texts)
+    {
+        if (!m_contextKeys.empty())
+            changed |= UpdateKey(m_contextKeys[i], ContextForKey(Item(i)));
+        if (!m_textKeys.empty())
+            changed |= UpdateKey(m_textKeys[i], TextForKey(Item(i)));
     }
 
-    // As last resort, sort by position in file. Note that this means that
-    // no two items are considered equal w.r.t. sort order; this ensures stable
-    // ordering.
-    return i < j;
+    return changed;
 }
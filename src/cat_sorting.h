@@ -29,7 +29,10 @@
 #include "catalog.h"
 #include "unicode_helpers.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 /// Sort order information
 struct SortOrder
@@ -77,7 +80,39 @@ public:
     CatalogItemsComparator(const CatalogItemsComparator&) = delete;
     CatalogItemsComparator& operator=(const CatalogItemsComparator&) = delete;
 
-    bool operator()(int i, int j) const;
+    /**
+        Updates cached sort criteria of item @a i after it was modified.
+
+        Flags-based criteria are always re-evaluated, this is cheap; collation
+        keys are only recomputed if @a texts is true. Returns true if the
+        item's position in the order may have changed.
+     */
+    bool UpdateItem(int i, bool texts);
+
+    bool operator()(int i, int j) const
+    {
+        if (m_prefix[i] != m_prefix[j])
+            return m_prefix[i] < m_prefix[j];
+
+        if (!m_contextKeys.empty())
+        {
+            auto r = CompareKeys(m_contextKeys[i], m_contextKeys[j]);
+            if (r != 0)
+                return r < 0;
+        }
+
+        if (!m_textKeys.empty())
+        {
+            auto r = CompareKeys(m_textKeys[i], m_textKeys[j]);
+            if (r != 0)
+                return r < 0;
+        }
+
+        // As last resort, sort by position in file. Note that this means that
+        // no two items are considered equal w.r.t. sort order; this ensures stable
+        // ordering.
+        return i < j;
+    }
 
 protected:
     const CatalogItem& Item(int i) const { return *m_catalog[i]; }
@@ -112,10 +147,41 @@ protected:
 	}
 
 private:
+    // Location of ICU binary sort key in m_keysArena
+    struct SortKey
+    {
+        uint32_t offset, length;
+    };
+
+    int CompareKeys(SortKey a, SortKey b) const
+    {
+        // keys are NUL-terminated, so a common prefix can only occur when they're equal:
+        return memcmp(m_keysArena.data() + a.offset, m_keysArena.data() + b.offset, std::min(a.length, b.length));
+    }
+
+    uint8_t MakePrefix(const CatalogItem& item) const;
+
+    // Strings that collation keys are computed from
+    static str::UCharBuffer ContextForKey(const CatalogItem& item);
+    str::UCharBuffer TextForKey(const CatalogItem& item) const;
+
+    // Computes sort keys for all items, in parallel, from strings returned by @a get
+    template<typename T>
+    std::vector<SortKey> BuildSortKeys(T&& get);
+
+    // Recomputes @a key from @a s, returns true if it changed
+    bool UpdateKey(SortKey& key, const UChar *s);
+
     const Catalog& m_catalog;
     SortOrder m_order;
     std::unique_ptr<unicode::Collator> m_collator;
-    std::vector<str::UCharBuffer> m_sortKeys;
+
+    // Packed flags-based criteria (errors, untranslated, presence of context),
+    // ordered so that smaller value sorts first
+    std::vector<uint8_t> m_prefix;
+    // ICU sort keys of contexts and of the sorted-by text, if used
+    std::vector<SortKey> m_contextKeys, m_textKeys;
+    std::vector<uint8_t> m_keysArena;
 };
 
 
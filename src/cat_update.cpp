@@ -28,6 +28,7 @@
 #include "catalog_po.h"
 #include "colorscheme.h"
 #include "custom_notebook.h"
+#include "edapp.h"
 #include "errors.h"
 #include "extractors/extractor.h"
 #include "hidpi.h"
@@ -253,15 +254,25 @@ InterimResults ExtractPOTFromSources(CatalogPtr catalog)
 
     if (!files.empty())
     {
+        const auto cacheDir = PoeditApp::GetCacheDir("Extraction");
+        auto creationDate = dispatch::async([=]{ return Extractor::GetSourcesModificationDate(*spec, files, cacheDir); });
+
         TempDirectory tmpdir;
-        auto result = Extractor::ExtractWithAll(tmpdir, *spec, files);
+        auto result = Extractor::ExtractWithAll(tmpdir, *spec, files, cacheDir);
         if (!result)
             BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
 
         try
         {
             output.errors = result.errors;
-            output.reference = POCatalog::Create(result.pot_file, Catalog::CreationFlag_IgnoreHeader);
+            if (result.catalog)
+                output.reference = result.catalog;
+            else
+                output.reference = POCatalog::Create(result.pot_file, Catalog::CreationFlag_IgnoreHeader);
+
+            auto date = creationDate.get();
+            if (!date.empty())
+                output.reference->Header().CreationDate = date;
             return output;
         }
         catch (...)
@@ -389,8 +400,11 @@ dispatch::future<CatalogPtr> DoPerformUpdateWithUI(wxWindow *parent,
         MergeStats stats;
         stats.errors = data.errors;
 
+        // determining differences is cheap compared to merging:
+        const int timeCostStats = (100 - timeCostObtainPOT) / 10;
+
         {
-            Progress subtask(1, p, (100 - timeCostObtainPOT) / 2);
+            Progress subtask(1, p, timeCostStats);
             subtask.message(_(L"Determining differences…"));
             ComputeMergeStats(stats, catalog, data.reference);
         }
@@ -398,7 +412,7 @@ dispatch::future<CatalogPtr> DoPerformUpdateWithUI(wxWindow *parent,
         cancellation->throw_if_cancelled();
 
         {
-            Progress subtask(1, p, (100 - timeCostObtainPOT) / 2);
+            Progress subtask(1, p, 100 - timeCostObtainPOT - timeCostStats);
             subtask.message(_(L"Merging differences…"));
             *merge_result = MergeCatalogWithReference(catalog, data.reference);
             if (!(*merge_result))
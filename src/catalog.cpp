@@ -32,6 +32,7 @@
 #include "catalog_resx.h"
 #include "catalog_qt.h"
 
+#include "concurrency.h"
 #include "configuration.h"
 #include "errors.h"
 #include "extractors/extractor.h"
@@ -54,6 +55,11 @@
 #include <wx/strconv.h>
 #include <wx/memtext.h>
 #include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
 
 #include <algorithm>
 #include <set>
@@ -580,6 +586,45 @@ bool Catalog::RemoveSameAsSourceTranslations()
 }
 
 
+std::vector<int> Catalog::ReplaceInTranslations(const std::function<bool(wxString&)>& replace)
+{
+    // Scanning for matches is the expensive part, it only reads the items and
+    // can be done in parallel. Modified items are only updated afterwards.
+    const size_t count = m_items.size();
+    std::vector<std::unique_ptr<wxArrayString>> updated(count);
+
+    dispatch::parallel_for(count, /*min_chunk=*/256, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            auto& orig = m_items[i]->GetTranslations();
+            for (size_t t = 0; t < orig.size(); t++)
+            {
+                wxString s(orig[t]);
+                if (!replace(s))
+                    continue;
+                if (!updated[i])
+                    updated[i].reset(new wxArrayString(orig));
+                (*updated[i])[t] = s;
+            }
+        }
+    });
+
+    std::vector<int> changed;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!updated[i])
+            continue;
+        auto& item = m_items[i];
+        item->SetTranslations(*updated[i]);
+        item->SetModified(true);
+        changed.push_back((int)i);
+    }
+
+    return changed;
+}
+
+
 namespace
 {
 
@@ -794,44 +839,243 @@ void Catalog::SetLanguage(Language lang)
     m_header.Lang = lang;
 }
 
+namespace
+{
+
+inline uint8_t StatesMask(const CatalogItem& item)
+{
+    uint8_t mask = 0;
+    if (!item.IsTranslated())
+        mask |= 1 << CatalogItemStates::Untranslated;
+    if (item.IsFuzzy())
+        mask |= 1 << CatalogItemStates::Fuzzy;
+    if (item.HasIssue())
+        mask |= 1 << (item.HasError() ? CatalogItemStates::Error : CatalogItemStates::Warning);
+    if (mask & ((1 << CatalogItemStates::Untranslated) | (1 << CatalogItemStates::Fuzzy) | (1 << CatalogItemStates::Error)))
+        mask |= 1 << CatalogItemStates::Unfinished;
+    return mask;
+}
+
+inline int CountTrailingZeros(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+} // anonymous namespace
+
+
+CatalogItemStates::CatalogItemStates(const CatalogItemArray& items)
+    : m_items(items),
+      m_masks(new std::atomic<uint8_t>[items.size()])
+{
+    const size_t words = (items.size() + 63) / 64;
+    for (auto& b: m_bits)
+        b = std::vector<std::atomic<uint64_t>>(words);
+    for (auto& c: m_counts)
+        c = 0;
+
+    for (size_t i = 0; i < m_items.size(); i++)
+    {
+        auto& item = *m_items[i];
+        const uint8_t mask = StatesMask(item);
+        m_masks[i] = mask;
+        for (int s = 0; s < StatesCount; s++)
+        {
+            if (mask & (1 << s))
+            {
+                m_bits[s][i / 64] |= uint64_t(1) << (i % 64);
+                m_counts[s]++;
+            }
+        }
+
+        item.m_states = this;
+        item.m_statesIndex = i;
+    }
+}
+
+
+CatalogItemStates::~CatalogItemStates()
+{
+    for (auto& i: m_items)
+    {
+        if (i->m_states == this)
+            i->m_states = nullptr;
+    }
+}
+
+
+void CatalogItemStates::Update(size_t index, const CatalogItem& item)
+{
+    const uint8_t mask = StatesMask(item);
+    const uint8_t changed = m_masks[index].exchange(mask, std::memory_order_relaxed) ^ mask;
+    if (!changed)
+        return;
+
+    const uint64_t bit = uint64_t(1) << (index % 64);
+    for (int s = 0; s < StatesCount; s++)
+    {
+        if (!(changed & (1 << s)))
+            continue;
+        if (mask & (1 << s))
+        {
+            m_bits[s][index / 64].fetch_or(bit, std::memory_order_relaxed);
+            m_counts[s].fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            m_bits[s][index / 64].fetch_and(~bit, std::memory_order_relaxed);
+            m_counts[s].fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+std::vector<int> CatalogItemStates::GetItems(State s) const
+{
+    std::vector<int> out;
+    out.reserve(Count(s));
+
+    auto& words = m_bits[s];
+    for (size_t w = 0; w < words.size(); w++)
+    {
+        uint64_t bits = words[w].load(std::memory_order_relaxed);
+        while (bits)
+        {
+            out.push_back(int(w * 64 + CountTrailingZeros(bits)));
+            bits &= bits - 1;
+        }
+    }
+
+    return out;
+}
+
+
+CatalogItemIndex::CatalogItemIndex(const CatalogItemArray& items)
+{
+    m_hashes.reserve(items.size());
+    Update(items);
+}
+
+
+void CatalogItemIndex::Update(const CatalogItemArray& items)
+{
+    for (size_t i = m_itemsCount; i < items.size(); i++)
+    {
+        auto& item = *items[i];
+        const auto hash = str::hash64().add(item.GetRawString()).value();
+        if (!m_hasDuplicates)
+        {
+            auto range = m_hashes.equal_range(hash);
+            for (auto j = range.first; j != range.second; ++j)
+            {
+                auto& other = *items[j->second];
+                if (other.GetRawString() == item.GetRawString() &&
+                    other.HasContext() == item.HasContext() && other.GetContext() == item.GetContext())
+                {
+                    m_hasDuplicates = true;
+                    break;
+                }
+            }
+        }
+        m_hashes.emplace(hash, (int)i);
+    }
+    m_itemsCount = items.size();
+}
+
+
+int CatalogItemIndex::Find(const CatalogItemArray& items, const wxString& str) const
+{
+    int found = -1;
+    auto range = m_hashes.equal_range(str::hash64().add(str).value());
+    for (auto i = range.first; i != range.second; ++i)
+    {
+        if (i->second > found && items[i->second]->GetRawString() == str)
+            found = i->second;
+    }
+    return found;
+}
+
+
+const CatalogItemIndex& Catalog::GetItemIndex() const
+{
+    if (!m_itemIndex || m_itemIndex->GetItemsCount() > m_items.size())
+    {
+        wxStopWatch sw;
+        m_itemIndex.reset(new CatalogItemIndex(m_items));
+        wxLogTrace("poedit", "built index of %d items in %ld ms", (int)m_items.size(), sw.Time());
+    }
+    else if (m_itemIndex->GetItemsCount() < m_items.size())
+        m_itemIndex->Update(m_items);
+    return *m_itemIndex;
+}
+
+
+CatalogItemPtr Catalog::FindItemByString(const wxString& str) const
+{
+    auto index = GetItemIndex().Find(m_items, str);
+    return index == -1 ? nullptr : m_items[index];
+}
+
+
+const CatalogItemStates& Catalog::GetItemStates()
+{
+    if (!m_itemStates || m_itemStates->GetItemsCount() != m_items.size())
+    {
+        // detach the old instance first, so that items can be attached to the new one:
+        m_itemStates.reset();
+        m_itemStates.reset(new CatalogItemStates(m_items));
+    }
+    return *m_itemStates;
+}
+
+
 void Catalog::GetStatistics(int *all, int *fuzzy, int *badtokens,
                             int *untranslated, int *unfinished)
 {
-    if (all) *all = 0;
-    if (fuzzy) *fuzzy = 0;
-    if (badtokens) *badtokens = 0;
-    if (untranslated) *untranslated = 0;
-    if (unfinished) *unfinished = 0;
+    // The counts are maintained incrementally as items change state:
+    auto& states = GetItemStates();
 
+    if (all) *all = (int)m_items.size();
+    if (fuzzy) *fuzzy = states.Count(CatalogItemStates::Fuzzy);
+    if (badtokens) *badtokens = states.Count(CatalogItemStates::Error);
+    if (untranslated) *untranslated = states.Count(CatalogItemStates::Untranslated);
+    if (unfinished) *unfinished = states.Count(CatalogItemStates::Unfinished);
+
+#ifndef NDEBUG
+    int countFuzzy = 0, countErrors = 0, countUntranslated = 0, countUnfinished = 0;
     for (auto& i: m_items)
     {
         bool ok = true;
-
-        if (all)
-            (*all)++;
-
         if (i->IsFuzzy())
         {
-            if (fuzzy)
-                (*fuzzy)++;
+            countFuzzy++;
             ok = false;
         }
         if (i->HasError())
         {
-            if (badtokens)
-                (*badtokens)++;
+            countErrors++;
             ok = false;
         }
         if (!i->IsTranslated())
         {
-            if (untranslated)
-                (*untranslated)++;
+            countUntranslated++;
             ok = false;
         }
-
-        if ( !ok && unfinished )
-            (*unfinished)++;
+        if (!ok)
+            countUnfinished++;
     }
+    wxASSERT_MSG(countFuzzy == states.Count(CatalogItemStates::Fuzzy) &&
+                 countErrors == states.Count(CatalogItemStates::Error) &&
+                 countUntranslated == states.Count(CatalogItemStates::Untranslated) &&
+                 countUnfinished == states.Count(CatalogItemStates::Unfinished),
+                 "incrementally maintained statistics are out of sync");
+#endif
 }
 
 
@@ -850,6 +1094,8 @@ void CatalogItem::SetFlags(const wxString& flags)
     {
         m_isFuzzy = false;
     }
+
+    NotifyStateChanged();
 }
 
 
@@ -891,10 +1137,14 @@ void CatalogItem::SetFuzzy(bool fuzzy)
     if (fuzzy == m_isFuzzy)
         return;
 
-    if (!fuzzy && m_isFuzzy)
+    if (!fuzzy && m_isFuzzy && !m_oldMsgid.empty())
+    {
         m_oldMsgid.clear();
+        m_generation++;
+    }
     m_isFuzzy = fuzzy;
 
+    NotifyStateChanged();
     UpdateInternalRepresentation();
 }
 
@@ -904,6 +1154,7 @@ void CatalogItem::SetComment(const wxString& c)
         return;
 
     m_comment = c;
+    m_generation++;
     UpdateInternalRepresentation();
 }
 
@@ -921,6 +1172,7 @@ void CatalogItem::SetTranslation(const wxString &t, unsigned idx)
     while (idx >= m_translations.GetCount())
         m_translations.Add(wxEmptyString);
     m_translations[idx] = t;
+    m_generation++;
 
     ClearIssue();
 
@@ -934,12 +1186,14 @@ void CatalogItem::SetTranslation(const wxString &t, unsigned idx)
         }
     }
 
+    NotifyStateChanged();
     UpdateInternalRepresentation();
 }
 
 void CatalogItem::SetTranslations(const wxArrayString &t)
 {
     m_translations = t;
+    m_generation++;
 
     ClearIssue();
 
@@ -953,6 +1207,7 @@ void CatalogItem::SetTranslations(const wxArrayString &t)
         }
     }
 
+    NotifyStateChanged();
     UpdateInternalRepresentation();
 }
 
@@ -962,6 +1217,7 @@ void CatalogItem::SetTranslationFromSource()
     m_isFuzzy = false;
     m_isPreTranslated = false;
     m_isTranslated = true;
+    m_generation++;
 
     auto iter = m_translations.begin();
     if (*iter != m_string)
@@ -983,6 +1239,7 @@ void CatalogItem::SetTranslationFromSource()
         }
     }
 
+    NotifyStateChanged();
     UpdateInternalRepresentation();
 }
 
@@ -1000,9 +1257,13 @@ void CatalogItem::ClearTranslation()
     }
 
     m_isModified = modified;
+    NotifyStateChanged();
 
     if (modified)
+    {
+        m_generation++;
         UpdateInternalRepresentation();
+    }
 }
 
 unsigned CatalogItem::GetPluralFormsCount() const
@@ -1051,7 +1312,12 @@ Catalog::ValidationResults Catalog::Validate(const wxString& /*fileWithSameConte
     {
         // TODO: _some_ checks (e.g. plurals) do make sense even with symbolic IDs
         if (!UsesSymbolicIDsForSource())
-            res.warnings = QAChecker::GetFor(*this)->Check(*this);
+        {
+            // most re-validations happen after small edits, reuse results for unchanged items:
+            auto checker = QAChecker::GetFor(*this);
+            checker->EnableCache();
+            res.warnings = checker->Check(*this);
+        }
     }
 #endif
 
@@ -1059,6 +1325,34 @@ Catalog::ValidationResults Catalog::Validate(const wxString& /*fileWithSameConte
 }
 
 
+int Catalog::ValidateItems(const std::vector<int>& indexes)
+{
+    for (int i: indexes)
+        m_items[i]->ClearIssue();
+
+    if (!HasCapability(Catalog::Cap::Translations))
+        return 0;
+
+    std::atomic<int> issues(0);
+#if wxUSE_GUI
+    if (Config::ShowWarnings() && !UsesSymbolicIDsForSource())
+    {
+        auto checker = QAChecker::GetFor(*this);
+        checker->EnableCache();
+        dispatch::parallel_for(indexes.size(), /*min_chunk=*/256, [&](size_t begin, size_t end)
+        {
+            int found = 0;
+            for (size_t i = begin; i < end; i++)
+                found += checker->Check(m_items[indexes[i]]);
+            issues += found;
+        });
+    }
+#endif
+
+    return issues;
+}
+
+
 void Catalog::PostCreation()
 {
     if (!m_sourceLanguage.IsValid())
@@ -1152,6 +1446,8 @@ CatalogPtr Catalog::Create(const wxString& filename, int flags)
     wxFileName::SplitPath(filename, nullptr, nullptr, nullptr, &ext);
     ext.MakeLower();
 
+    const bool partial = (flags & CreationFlag_Partial) != 0;
+
     CatalogPtr cat;
     if (POCatalog::CanLoadFile(ext))
     {
@@ -1189,7 +1485,8 @@ CatalogPtr Catalog::Create(const wxString& filename, int flags)
     }
 
     cat->SetFileName(filename);
-    cat->PostCreation();
+    if (!partial)
+        cat->PostCreation();
 
     return cat;
 }
@@ -1208,18 +1505,15 @@ bool Catalog::CanLoadFile(const wxString& extension_)
 
 void Catalog::SideloadSourceDataFromReferenceFile(CatalogPtr ref)
 {
-    std::map<wxString, CatalogItemPtr> refItems;
-
-    for (auto iref: ref->items())
-        refItems[iref->GetRawString()] = iref;
+    wxStopWatch sw;
 
     for (auto i: this->items())
     {
-        auto ri = refItems.find(i->GetRawString());
-        if (ri == refItems.end())
+        auto ri = ref->FindItemByString(i->GetRawString());
+        if (!ri)
             continue;
 
-        auto& rdata = *ri->second;
+        auto& rdata = *ri;
         if (rdata.GetTranslation().empty())
             continue;
 
@@ -1236,6 +1530,9 @@ void Catalog::SideloadSourceDataFromReferenceFile(CatalogPtr ref)
     m_sideloaded = std::make_shared<SideloadedCatalogData>();
     m_sideloaded->reference_file = ref;
     m_sideloaded->source_language = ref->GetLanguage();
+
+    wxLogTrace("poedit", "sideloaded source text for %d items from %d items in %ld ms",
+               (int)m_items.size(), (int)ref->items().size(), sw.Time());
 }
 
 void Catalog::ClearSideloadedSourceData()
@@ -32,10 +32,13 @@
 #include <wx/arrstr.h>
 #include <wx/textfile.h>
 
+#include <atomic>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 class CloudSyncDestination;
@@ -43,6 +46,7 @@ struct SourceCodeSpec;
 
 class Catalog;
 class CatalogItem;
+class CatalogItemStates;
 typedef std::shared_ptr<CatalogItem> CatalogItemPtr;
 typedef std::shared_ptr<Catalog> CatalogPtr;
 
@@ -94,7 +98,9 @@ class CatalogItem
                   m_isTranslated(false),
                   m_isModified(false),
                   m_isPreTranslated(false),
-                  m_lineNum(0)
+                  m_lineNum(0),
+                  m_generation(0),
+                  m_qaFingerprint(0)
         {}
 
         CatalogItem(const CatalogItem&) = delete;
@@ -217,7 +223,7 @@ class CatalogItem
         /// Sets fuzzy flag.
         void SetFuzzy(bool fuzzy);
         /// Sets translated flag.
-        void SetTranslated(bool t) { m_isTranslated = t; }
+        void SetTranslated(bool t) { m_isTranslated = t; NotifyStateChanged(); }
         /// Sets modified flag.
         void SetModified(bool modified) { m_isModified = modified; }
         /// Sets pre-translated translation flag.
@@ -250,13 +256,28 @@ class CatalogItem
         bool HasError() const { return m_issue && m_issue->severity == Issue::Error; }
         const std::shared_ptr<Issue>& GetIssue() const { return m_issue; }
 
-        void ClearIssue() { m_issue.reset(); }
-        void SetIssue(std::shared_ptr<Issue> issue) { m_issue = issue; }
-        void SetIssue(const Issue& issue) { m_issue = std::make_shared<Issue>(issue); }
-        void SetIssue(Issue::Severity severity, const wxString& message) { m_issue = std::make_shared<Issue>(severity, message); }
+        void ClearIssue() { m_issue.reset(); NotifyStateChanged(); }
+        void SetIssue(std::shared_ptr<Issue> issue) { m_issue = issue; NotifyStateChanged(); }
+        void SetIssue(const Issue& issue) { m_issue = std::make_shared<Issue>(issue); NotifyStateChanged(); }
+        void SetIssue(Issue::Severity severity, const wxString& message) { m_issue = std::make_shared<Issue>(severity, message); NotifyStateChanged(); }
+
+        /// Counter incremented whenever source, plural, context, translation, old msgid
+        /// or comment texts change, allowing views to cache their presentation of the item.
+        unsigned GetGeneration() const { return m_generation; }
+
+        /// Fingerprint of the content QA checks last ran on (0 if never checked)
+        uint64_t GetQAFingerprint() const { return m_qaFingerprint; }
+        /// Issue found by the last QA check with GetQAFingerprint(), if any
+        const std::shared_ptr<Issue>& GetQAIssue() const { return m_qaIssue; }
+        /// Remembers QA result for reuse by QAChecker while the content is unchanged
+        void SetQAResult(uint64_t fingerprint, const std::shared_ptr<Issue>& issue)
+        {
+            m_qaFingerprint = fingerprint;
+            m_qaIssue = issue;
+        }
 
-        void AttachSideloadedData(const std::shared_ptr<SideloadedItemData>& d) { m_sideloaded = d; }
-        void ClearSideloadedData() { m_sideloaded.reset(); }
+        void AttachSideloadedData(const std::shared_ptr<SideloadedItemData>& d) { m_sideloaded = d; m_generation++; }
+        void ClearSideloadedData() { m_sideloaded.reset(); m_generation++; }
 
     protected:
         // API for subclasses:
@@ -272,6 +293,7 @@ class CatalogItem
         void SetString(const wxString& s)
         {
             m_string = s;
+            m_generation++;
             ClearIssue();
         }
 
@@ -279,12 +301,14 @@ class CatalogItem
         {
             m_plural = p;
             m_hasPlural = true;
+            m_generation++;
         }
 
         void SetContext(const wxString& context)
         {
             m_hasContext = true;
             m_context = context;
+            m_generation++;
         }
 
         void SetLineNumber(int line) { m_lineNum = line; }
@@ -292,9 +316,10 @@ class CatalogItem
         void AddExtractedComments(const wxString& com)
         {
             m_extractedComments.Add(com);
+            m_generation++;
         }
 
-        void SetOldMsgid(const wxArrayString& data) { m_oldMsgid = data; }
+        void SetOldMsgid(const wxArrayString& data) { m_oldMsgid = data; m_generation++; }
 
         /** Sets gettext flags directly in string format. It may be
             either empty string or ", fuzzy", ", c-format",
@@ -320,15 +345,125 @@ class CatalogItem
         wxString m_moreFlags;
         wxString m_comment;
         int m_lineNum;
+        unsigned m_generation;
 
         std::shared_ptr<Issue> m_issue;
         std::shared_ptr<SideloadedItemData> m_sideloaded;
+
+        uint64_t m_qaFingerprint;
+        std::shared_ptr<Issue> m_qaIssue;
+
+    private:
+        // Reports changes of translated, fuzzy or issue state to the
+        // catalog's CatalogItemStates, if attached
+        inline void NotifyStateChanged();
+
+        friend class CatalogItemStates;
+        CatalogItemStates *m_states = nullptr;
+        size_t m_statesIndex = 0;
 };
 
 
 typedef std::vector<CatalogItemPtr> CatalogItemArray;
 
 
+/**
+    Tracks state of catalog items (untranslated, fuzzy, with errors etc.)
+    in per-state bitsets, allowing cheap counting and enumeration of items
+    in given state, e.g. for filtering.
+
+    Once created, it is kept up to date by CatalogItem's state setters. Those
+    may be called from multiple threads (QA checks run in parallel), so the
+    updates are atomic. Use Catalog::GetItemStates() to obtain it.
+ */
+class CatalogItemStates
+{
+public:
+    enum State
+    {
+        Untranslated,
+        Fuzzy,
+        Error,
+        Warning,
+        Unfinished,     // any of untranslated, fuzzy or with error
+        StatesCount
+    };
+
+    /// Attaches to given items; they must not be attached to another instance
+    explicit CatalogItemStates(const CatalogItemArray& items);
+    ~CatalogItemStates();
+
+    CatalogItemStates(const CatalogItemStates&) = delete;
+    CatalogItemStates& operator=(const CatalogItemStates&) = delete;
+
+    /// Number of tracked items
+    size_t GetItemsCount() const { return m_items.size(); }
+
+    /// Number of items in state @a s
+    int Count(State s) const { return m_counts[s].load(std::memory_order_relaxed); }
+
+    /// Is catalog item with index @a index in state @a s?
+    bool Has(State s, size_t index) const
+    {
+        return (m_bits[s][index / 64].load(std::memory_order_relaxed) >> (index % 64)) & 1;
+    }
+
+    /// Returns indexes of all items in state @a s, in ascending order
+    std::vector<int> GetItems(State s) const;
+
+private:
+    friend class CatalogItem;
+    void Update(size_t index, const CatalogItem& item);
+
+    CatalogItemArray m_items;
+    std::unique_ptr<std::atomic<uint8_t>[]> m_masks;
+    std::vector<std::atomic<uint64_t>> m_bits[StatesCount];
+    std::atomic<int> m_counts[StatesCount];
+};
+
+
+/**
+    Index of catalog items by their source string, allowing fast lookup of
+    items and detection of duplicates (items with the same context and source
+    string).
+
+    Only 64bit hashes of the strings are stored, so the index is compact and
+    cheap to build even for huge catalogs; candidate items are compared with
+    the string to rule out hash collisions. Use Catalog::GetItemIndex() to
+    obtain it.
+ */
+class CatalogItemIndex
+{
+public:
+    /// Builds the index for @a items
+    explicit CatalogItemIndex(const CatalogItemArray& items);
+
+    /// Number of indexed items
+    size_t GetItemsCount() const { return m_itemsCount; }
+
+    /// Adds items from @a items that were appended since the index was built
+    void Update(const CatalogItemArray& items);
+
+    /// Returns index of the last item in @a items with source string @a str, or -1
+    int Find(const CatalogItemArray& items, const wxString& str) const;
+
+    /// Whether there are several items with the same context and source string
+    bool HasDuplicates() const { return m_hasDuplicates; }
+
+private:
+    std::unordered_multimap<uint64_t, int> m_hashes;
+    size_t m_itemsCount = 0;
+    bool m_hasDuplicates = false;
+};
+
+
+inline void CatalogItem::NotifyStateChanged()
+{
+    if (m_states)
+        m_states->Update(m_statesIndex, *this);
+}
+
+
 /** This class stores all translations, together with filelists, references
     and other additional information. It can read .po files and save both
     .mo and .po files. Furthermore, it provides facilities for updating the
@@ -428,7 +563,10 @@ class Catalog
         enum CreationFlags
         {
             CreationFlag_IgnoreHeader       = 1,
-            CreationFlag_IgnoreTranslations = 2
+            CreationFlag_IgnoreTranslations = 2,
+            // file is only a part of a catalog, e.g. to be concatenated,
+            // so skip detection of languages and similar post-processing:
+            CreationFlag_Partial            = 4
         };
 
         enum class CompilationStatus
@@ -550,6 +688,27 @@ class Catalog
         void GetStatistics(int *all, int *fuzzy, int *badtokens,
                            int *untranslated, int *unfinished);
 
+        /**
+            Returns item states tracker for this catalog's items.
+
+            It is created on first use and kept up to date afterwards, as long
+            as the set of items doesn't change. Must be called from the main
+            thread.
+         */
+        const CatalogItemStates& GetItemStates();
+
+        /**
+            Returns index of items by their source string.
+
+            It is created on first use and updated with items appended
+            afterwards. Not thread-safe.
+         */
+        const CatalogItemIndex& GetItemIndex() const;
+
+        /// Finds item with (raw) source string @a str, regardless of its context.
+        /// If several items have it (in different contexts), the last one is returned.
+        CatalogItemPtr FindItemByString(const wxString& str) const;
+
         /// Gets n-th item in the catalog (read-write access).
         CatalogItemPtr operator[](unsigned n) { return m_items[n]; }
 
@@ -588,6 +747,17 @@ class Catalog
         /// Removes translations identical to the source text, returns true if any changes were made
         bool RemoveSameAsSourceTranslations();
 
+        /**
+            Replaces text in translations of all items at once.
+
+            @a replace is called, in parallel, with every translation and
+            modifies it in place, returning true if it changed it. All changes
+            are applied after the whole catalog was scanned.
+
+            Returns catalog indexes of modified items.
+         */
+        std::vector<int> ReplaceInTranslations(const std::function<bool(wxString&)>& replace);
+
         /// Finds item by line number
         CatalogItemPtr FindItemByLine(int lineno);
 
@@ -599,6 +769,10 @@ class Catalog
         /// Returns number of errors (i.e. 0 if no errors).
         virtual ValidationResults Validate(const wxString& fileWithSameContent = wxString());
 
+        /// Re-runs QA checks on given items only, e.g. after bulk changes to
+        /// them. Returns number of issues found.
+        int ValidateItems(const std::vector<int>& indexes);
+
         void AttachCloudSync(std::shared_ptr<CloudSyncDestination> c) { m_cloudSync = c; }
         std::shared_ptr<CloudSyncDestination> GetCloudSync() const { return m_cloudSync; }
 
@@ -627,8 +801,13 @@ class Catalog
         /// Perform post-creation processing to e.g. fixup issues, detect missing language etc.
         virtual void PostCreation();
 
+        /// Must be called when items are added to or removed from m_items
+        void InvalidateItemStates() { m_itemStates.reset(); m_itemIndex.reset(); }
+
     protected:
         CatalogItemArray m_items;
+        std::unique_ptr<CatalogItemStates> m_itemStates;
+        mutable std::unique_ptr<CatalogItemIndex> m_itemIndex;
 
         Type m_fileType;
         wxString m_fileName;
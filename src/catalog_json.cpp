@@ -34,10 +34,11 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <map>
 #include <memory>
-#include <sstream>
 
 
 namespace
@@ -45,17 +46,18 @@ namespace
 
 // Try to determine JSON file's formatting, i.e. line endings and identation, by inspecting the
 // beginning of the file.
-void DetectFileFormatting(std::ifstream& f, int& indent, char& indent_char, bool& dos_line_endings)
+void DetectFileFormatting(const std::string& text, int& indent, char& indent_char, bool& dos_line_endings)
 {
     // fallback defaults: compact representation with no indentation
     indent = -1;
     indent_char = ' ';
     dos_line_endings = false;
 
-    for (int counter = 0; counter < 100; ++counter)
+    const size_t len = std::min(text.size(), size_t(100));
+    for (size_t pos = 0; pos < len; ++pos)
     {
-        auto c = f.get();
-        if (c == '\r' && f.peek() == '\n')
+        auto c = text[pos];
+        if (c == '\r' && pos + 1 < text.size() && text[pos + 1] == '\n')
         {
             dos_line_endings = true;
         }
@@ -81,6 +83,113 @@ void DetectFileFormatting(std::ifstream& f, int& indent, char& indent_char, bool
     }
 }
 
+
+// Iterator over JSON text that keeps track of how much of it the parser consumed.
+class OffsetTrackingIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = char;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const char*;
+    using reference = const char&;
+
+    OffsetTrackingIterator(const std::string& text, size_t pos, size_t& offset)
+        : m_ptr(text.data() + pos), m_base(text.data()), m_offset(&offset) {}
+
+    reference operator*() const { return *m_ptr; }
+    OffsetTrackingIterator& operator++() { *m_offset = ++m_ptr - m_base; return *this; }
+
+    bool operator==(const OffsetTrackingIterator& other) const { return m_ptr == other.m_ptr; }
+    bool operator!=(const OffsetTrackingIterator& other) const { return m_ptr != other.m_ptr; }
+
+private:
+    const char *m_ptr, *m_base;
+    size_t *m_offset;
+};
+
+
+// SAX handler recording locations of string and null values in the text, in document order.
+// When a value is reported, the parser consumed exactly the text up to the end of it.
+class ValueSpansCollector
+{
+public:
+    typedef JSONCatalog::json_t json_t;
+
+    struct Span
+    {
+        size_t begin, end;
+    };
+
+    ValueSpansCollector(const std::string& text) : m_text(text) {}
+
+    std::vector<Span> spans;
+    size_t keys = 0;
+    size_t offset = 0;
+
+    bool null()
+    {
+        spans.push_back({offset - 4, offset});
+        return true;
+    }
+
+    bool string(json_t::string_t&)
+    {
+        // find the opening quote matching the closing one we're at:
+        size_t begin = offset - 1;
+        do
+        {
+            begin = m_text.rfind('"', begin - 1);
+        } while (IsEscaped(begin));
+
+        spans.push_back({begin, offset});
+        return true;
+    }
+
+    bool key(json_t::string_t&) { keys++; return true; }
+
+    bool boolean(bool) { return true; }
+    bool number_integer(json_t::number_integer_t) { return true; }
+    bool number_unsigned(json_t::number_unsigned_t) { return true; }
+    bool number_float(json_t::number_float_t, const json_t::string_t&) { return true; }
+    bool binary(json_t::binary_t&) { return true; }
+    bool start_object(std::size_t) { return true; }
+    bool end_object() { return true; }
+    bool start_array(std::size_t) { return true; }
+    bool end_array() { return true; }
+
+    bool parse_error(std::size_t, const std::string&, const json_t::exception&) { return false; }
+
+private:
+    bool IsEscaped(size_t pos) const
+    {
+        size_t backslashes = 0;
+        while (pos > backslashes && m_text[pos - backslashes - 1] == '\\')
+            backslashes++;
+        return backslashes % 2 == 1;
+    }
+
+    const std::string& m_text;
+};
+
+
+// Collects nodes of the values that ValueSpansCollector records, in the same order,
+// and counts object keys.
+void CollectValueNodes(const JSONCatalog::json_t& node, std::vector<const JSONCatalog::json_t*>& values, size_t& keys)
+{
+    if (node.is_string() || node.is_null())
+    {
+        values.push_back(&node);
+    }
+    else if (node.is_object() || node.is_array())
+    {
+        if (node.is_object())
+            keys += node.size();
+        for (auto& child : node)
+            CollectValueNodes(child, values, keys);
+    }
+}
+
 } // anonymous namespace
 
 
@@ -121,18 +230,23 @@ std::shared_ptr<JSONCatalog> JSONCatalog::Open(const wxString& filename)
     try
     {
         const auto ext = str::to_utf8(wxFileName(filename).GetExt().Lower());
-        std::ifstream f(filename.fn_str(), std::ios::binary);
-        auto data = json_t::parse(f);
+
+        std::string text;
+        {
+            std::ifstream f(filename.fn_str(), std::ios::binary);
+            text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+
+        auto data = json_t::parse(text);
 
         auto cat = CreateForJSON(std::move(data), ext);
         if (!cat)
             BOOST_THROW_EXCEPTION(JSONUnrecognizedFileException());
 
-        f.clear();
-        f.seekg(0, std::ios::beg);
-        DetectFileFormatting(f, cat->m_formatting.indent, cat->m_formatting.indent_char, cat->m_formatting.dos_line_endings);
+        DetectFileFormatting(text, cat->m_formatting.indent, cat->m_formatting.indent_char, cat->m_formatting.dos_line_endings);
 
         cat->Parse();
+        cat->ResetSourceText(std::move(text));
 
         return cat;
     }
@@ -176,6 +290,15 @@ bool JSONCatalog::Save(const wxString& filename, bool /*save_mo*/,
 
 std::string JSONCatalog::SaveToBuffer()
 {
+    const bool patched = PatchSourceText();
+
+    for (auto& i: m_items)
+        std::static_pointer_cast<JSONCatalogItem>(i)->ClearDirty();
+    m_dirtyNodes.clear();
+
+    if (patched)
+        return m_sourceText;
+
     auto s = m_doc.dump(m_formatting.indent, m_formatting.indent_char, /*ensure_ascii=*/false);
     if (s.empty())
         return s; // shouldn't be possible...
@@ -188,10 +311,139 @@ std::string JSONCatalog::SaveToBuffer()
     {
         boost::replace_all(s, "\n", "\r\n");
     }
+
+    ResetSourceText(s);
     return s;
 }
 
 
+void JSONCatalog::SetDocumentString(const char *key, const std::string& value)
+{
+    // adding a key may reallocate the object's storage, leaving recorded locations dangling
+    if (!m_doc.contains(key))
+        ResetSourceText();
+
+    auto& node = m_doc[key];
+    node = value;
+    m_dirtyNodes.push_back(&node);
+}
+
+
+void JSONCatalog::ResetSourceText(std::string text)
+{
+    m_sourceText = std::move(text);
+    m_sourceSpans.clear();
+    m_sourceSpansIndex.clear();
+}
+
+
+bool JSONCatalog::IndexSourceText()
+{
+    const auto& text = m_sourceText;
+
+    ValueSpansCollector collector(text);
+    if (!json_t::sax_parse(OffsetTrackingIterator(text, 0, collector.offset),
+                           OffsetTrackingIterator(text, text.size(), collector.offset),
+                           &collector))
+    {
+        ResetSourceText();
+        return false;
+    }
+
+    // Values are matched with DOM nodes by their order. That only works if the DOM
+    // has the same structure as the text. It doesn't if the text had duplicate keys
+    // or if keys were added to the DOM since (string values changed in place are fine):
+    std::vector<const json_t*> nodes;
+    size_t keys = 0;
+    CollectValueNodes(m_doc, nodes, keys);
+    if (nodes.size() != collector.spans.size() || keys != collector.keys)
+    {
+        ResetSourceText();
+        return false;
+    }
+
+    m_sourceSpans.reserve(nodes.size());
+    m_sourceSpansIndex.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        m_sourceSpans.push_back({nodes[i], collector.spans[i].begin, collector.spans[i].end});
+        m_sourceSpansIndex.emplace(nodes[i], i);
+    }
+
+    return true;
+}
+
+
+bool JSONCatalog::PatchSourceText()
+{
+    if (m_sourceText.empty())
+        return false;
+    if (m_sourceSpans.empty() && !IndexSourceText())
+        return false;
+
+    std::vector<size_t> modified;
+    auto add_modified = [&modified,this](const json_t *node)
+    {
+        auto i = node ? m_sourceSpansIndex.find(node) : m_sourceSpansIndex.end();
+        if (i == m_sourceSpansIndex.end())
+            return false;
+        modified.push_back(i->second);
+        return true;
+    };
+
+    for (auto node: m_dirtyNodes)
+    {
+        if (!add_modified(node))
+            return false;
+    }
+    for (auto& i: m_items)
+    {
+        auto item = static_cast<JSONCatalogItem*>(i.get());
+        if (item->IsDirty() && !add_modified(item->GetTranslationNode()))
+            return false;
+    }
+
+    if (modified.empty())
+        return true;
+
+    std::sort(modified.begin(), modified.end());
+    modified.erase(std::unique(modified.begin(), modified.end()), modified.end());
+
+    // copy the text verbatim except for modified values, updating their locations as we go:
+    std::string out;
+    out.reserve(m_sourceText.size() + m_sourceText.size() / 16);
+
+    size_t copied = 0;
+    std::ptrdiff_t shift = 0;
+    auto next = modified.begin();
+    for (size_t i = 0; i < m_sourceSpans.size(); ++i)
+    {
+        auto& span = m_sourceSpans[i];
+        if (next != modified.end() && *next == i)
+        {
+            ++next;
+            out.append(m_sourceText, copied, span.begin - copied);
+            copied = span.end;
+
+            const size_t begin = out.size();
+            out += span.node->dump(-1, ' ', /*ensure_ascii=*/false);
+            shift = std::ptrdiff_t(out.size()) - std::ptrdiff_t(span.end);
+            span.begin = begin;
+            span.end = out.size();
+        }
+        else
+        {
+            span.begin += shift;
+            span.end += shift;
+        }
+    }
+    out.append(m_sourceText, copied, std::string::npos);
+
+    m_sourceText = std::move(out);
+    return true;
+}
+
+
 class GenericJSONItem : public JSONCatalogItem
 {
 public:
@@ -214,6 +466,7 @@ public:
     void UpdateInternalRepresentation() override
     {
         m_node = str::to_utf8(GetTranslation());
+        m_dirty = true;
     }
 };
 
@@ -311,7 +564,7 @@ public:
     void SetLanguage(Language lang) override
     {
         JSONCatalog::SetLanguage(lang);
-        m_doc["@@locale"] = lang.Code();
+        SetDocumentString("@@locale", lang.Code());
     }
 
     void Parse() override
@@ -403,7 +656,8 @@ protected:
     class Item : public JSONCatalogItem
     {
     public:
-        Item(int id, const std::string& key, json_t& node) : JSONCatalogItem(id, node)
+        Item(int id, const std::string& key, json_t& node)
+            : JSONCatalogItem(id, node), m_hadMessage(node.contains("message"))
         {
             m_string = str::to_wx(key);
 
@@ -419,9 +673,18 @@ protected:
         void UpdateInternalRepresentation() override
         {
             m_node["message"] = str::to_utf8(GetTranslation());
+            m_dirty = true;
+        }
+
+        const json_t *GetTranslationNode() const override
+        {
+            return m_hadMessage ? &m_node.at("message") : nullptr;
         }
 
         std::string GetInternalFormatFlag() const override { return "ph-dollars"; }
+
+    private:
+        bool m_hadMessage;
     };
 };
 
@@ -468,7 +731,7 @@ public:
     void SetLanguage(Language lang) override
     {
         JSONCatalog::SetLanguage(lang);
-        m_doc["targetLocale"] = lang.LanguageTag();
+        SetDocumentString("targetLocale", lang.LanguageTag());
     }
 
 protected:
@@ -476,7 +739,7 @@ protected:
     {
     public:
         Item(int id, const std::string& filename, json_t& node)
-            : JSONCatalogItem(id, node), m_filename(filename)
+            : JSONCatalogItem(id, node), m_filename(filename), m_hadValue(node.contains("value"))
         {
             m_string = str::to_wx(node.at("source").get<std::string>());
             auto trans = str::to_wx(node.value("value", ""));
@@ -513,6 +776,12 @@ protected:
         void UpdateInternalRepresentation() override
         {
             m_node["value"] = str::to_utf8(GetTranslation());
+            m_dirty = true;
+        }
+
+        const json_t *GetTranslationNode() const override
+        {
+            return m_hadValue ? &m_node.at("value") : nullptr;
         }
 
         wxArrayString GetReferences() const override
@@ -525,6 +794,7 @@ protected:
 
     private:
         std::string m_filename;
+        bool m_hadValue;
     };
 
 };
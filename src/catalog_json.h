@@ -31,6 +31,7 @@
 
 #include "json.h"
 
+#include <unordered_map>
 #include <vector>
 
 
@@ -56,8 +57,19 @@ public:
 
     wxArrayString GetReferences() const override { return wxArrayString(); }
 
+    /**
+        Returns the node holding the translation or nullptr if it wasn't
+        present in the document when it was loaded.
+     */
+    virtual const json_t *GetTranslationNode() const { return &m_node; }
+
+    /// Does the translation need to be written into the file when saving?
+    bool IsDirty() const { return m_dirty; }
+    void ClearDirty() { m_dirty = false; }
+
 protected:
     json_t& m_node;
+    bool m_dirty = false;
 };
 
 
@@ -89,9 +101,37 @@ protected:
 
     virtual void Parse() = 0;
 
+    /// Sets top-level @a key in the document to string @a value
+    void SetDocumentString(const char *key, const std::string& value);
+
 private:
     static std::shared_ptr<JSONCatalog> CreateForJSON(json_t&& doc, const std::string& extension);
 
+    // Changes are saved by patching modified values in the file's original text
+    // where possible, preserving its formatting and avoiding serialization of
+    // the whole document. Locations of values are only found when first saving,
+    // so that loading isn't slowed down:
+
+    /// Sets text that m_doc was loaded from or saved to, possibly empty if unknown
+    void ResetSourceText(std::string text = std::string());
+
+    /// Records locations of values in m_sourceText, discarding it if not possible
+    bool IndexSourceText();
+
+    /// Writes modified values into m_sourceText; returns false if not possible
+    bool PatchSourceText();
+
+    struct ValueSpan
+    {
+        const json_t *node;
+        size_t begin, end;
+    };
+
+    std::string m_sourceText;
+    std::vector<ValueSpan> m_sourceSpans;
+    std::unordered_map<const json_t*, size_t> m_sourceSpansIndex;
+    std::vector<const json_t*> m_dirtyNodes;
+
 protected:
     json_t m_doc;
     Language m_language;
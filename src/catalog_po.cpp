@@ -50,6 +50,7 @@
 
 #include <set>
 #include <algorithm>
+#include <unordered_map>
 
 #ifdef __WXOSX__
 #import <Foundation/Foundation.h>
@@ -757,6 +758,81 @@ bool POLoadParser::OnDeletedEntry(const wxArrayString& deletedLines,
 }
 
 
+// Only counts entries, without creating catalog items
+class POStatsParser : public POCatalogParser
+{
+    public:
+        POStatsParser(wxTextFile *f)
+              : POCatalogParser(f),
+                FileIsValid(false),
+                m_seenHeaderAlready(false) {}
+
+        // true if the file is valid, i.e. has at least some data
+        bool FileIsValid;
+
+        POCatalog::FileStatistics Stats;
+
+    protected:
+        bool OnEntry(const wxString& msgid,
+                     const wxString& /*msgid_plural*/,
+                     bool /*has_plural*/,
+                     bool has_context,
+                     const wxString& /*context*/,
+                     const wxArrayString& mtranslations,
+                     const wxString& flags,
+                     const wxArrayString& /*references*/,
+                     const wxString& /*comment*/,
+                     const wxArrayString& /*extractedComments*/,
+                     const wxArrayString& /*msgid_old*/,
+                     unsigned /*lineNumber*/) override
+        {
+            FileIsValid = true;
+
+            // same logic as in POLoadParser and CatalogItem:
+            if (msgid.empty() && !has_context)
+            {
+                if (!m_seenHeaderAlready)
+                {
+                    Catalog::HeaderData hdr;
+                    hdr.FromString(mtranslations[0]);
+                    Stats.revisionDate = hdr.RevisionDate;
+                    m_seenHeaderAlready = true;
+                }
+                return true;
+            }
+
+            Stats.all++;
+            if (flags.find(wxS(", fuzzy")) != wxString::npos)
+                Stats.fuzzy++;
+            for (auto& t: mtranslations)
+            {
+                if (t.empty())
+                {
+                    Stats.untranslated++;
+                    break;
+                }
+            }
+            return true;
+        }
+
+        bool OnDeletedEntry(const wxArrayString& /*deletedLines*/,
+                            const wxString& /*flags*/,
+                            const wxArrayString& /*references*/,
+                            const wxString& /*comment*/,
+                            const wxArrayString& /*extractedComments*/,
+                            unsigned /*lineNumber*/) override
+        {
+            FileIsValid = true;
+            return true;
+        }
+
+        void OnIgnoredEntry() override { FileIsValid = true; }
+
+    private:
+        bool m_seenHeaderAlready;
+};
+
+
 // ----------------------------------------------------------------------
 // POCatalogItem class
 // ----------------------------------------------------------------------
@@ -816,6 +892,76 @@ wxArrayString POCatalogItem::GetReferences() const
 }
 
 
+void POCatalogItem::MergeDuplicate(const POCatalogItem& other, const wxString& label)
+{
+    for (auto& r: other.m_references)
+    {
+        if (m_references.Index(r) == wxNOT_FOUND)
+            m_references.push_back(r);
+    }
+
+    for (auto& c: other.m_extractedComments)
+    {
+        if (m_extractedComments.Index(c) == wxNOT_FOUND)
+            AddExtractedComments(c);
+    }
+
+    // comments are stored as raw "# ..." lines:
+    if (m_comment.empty())
+        SetComment(other.m_comment);
+    else if (!other.m_comment.empty() && !m_comment.Contains(other.m_comment))
+        SetComment(m_comment + (m_comment.EndsWith("\n") ? "" : "\n") + other.m_comment);
+
+    if (!m_hasPlural && other.m_hasPlural)
+        SetPluralString(other.m_plural);
+
+    auto hasTranslation = [](const wxArrayString& t){ return !t.empty() && !t[0].empty(); };
+    if (hasTranslation(other.m_translations))
+    {
+        if (!hasTranslation(m_translations))
+        {
+            SetTranslations(other.m_translations);
+        }
+        else if (m_translations != other.m_translations)
+        {
+            // keep all variants, marked the same way msgcat does:
+            const wxString marker = "#-#-#-#-#  " + label + "  #-#-#-#-#\n";
+            auto isMarked = [&](const wxString& t){ return t.StartsWith(marker); };
+
+            wxArrayString merged;
+            const size_t count = std::max(m_translations.size(), other.m_translations.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                wxString a = i < m_translations.size() ? m_translations[i] : wxString();
+                wxString b = i < other.m_translations.size() ? other.m_translations[i] : wxString();
+                if (!isMarked(a))
+                    a = marker + a;
+                merged.push_back(a + "\n" + marker + b);
+            }
+            SetTranslations(merged);
+            SetFuzzy(true);
+        }
+    }
+
+    // flags are in the ", flag1, flag2" form:
+    auto flags = GetFlags();
+    bool flagsChanged = false;
+    wxStringTokenizer tkn(other.GetFlags(), ",");
+    while (tkn.HasMoreTokens())
+    {
+        auto f = tkn.GetNextToken().Strip(wxString::both);
+        if (f.empty())
+            continue;
+        if (wxSplit(flags, ',').Index(" " + f) != wxNOT_FOUND)
+            continue;
+        flags += ", " + f;
+        flagsChanged = true;
+    }
+    if (flagsChanged)
+        SetFlags(flags);
+}
+
+
 // ----------------------------------------------------------------------
 // POCatalog class
 // ----------------------------------------------------------------------
@@ -888,42 +1034,68 @@ static inline wxString GetCurrentTimeString()
 }
 
 
-void POCatalog::Load(const wxString& po_file, int flags)
+namespace
 {
-    wxTextFile f;
-
-    Clear();
-    m_fileName = po_file;
-    m_header.BasePath = wxEmptyString;
-
-    wxString ext;
-    wxFileName::SplitPath(po_file, nullptr, nullptr, &ext);
-    if (ext.CmpNoCase("pot") == 0 || (flags & CreationFlag_IgnoreTranslations))
-        m_fileType = Type::POT;
-    else
-        m_fileType = Type::PO;
-
-    /* Load the .po file: */
 
+// Opens PO file in the charset declared in its header, which is returned
+wxString OpenPOFile(wxTextFile& f, const wxString& po_file)
+{
     if (!f.Open(po_file, wxConvISO8859_1))
     {
         BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
     }
 
+    wxString charset;
     {
         wxLogNull null; // don't report parsing errors from here, report them later
         POCharsetInfoFinder charsetFinder(&f);
         charsetFinder.Parse();
-        m_header.Charset = charsetFinder.GetCharset();
+        charset = charsetFinder.GetCharset();
     }
 
     f.Close();
-    wxCSConv encConv(m_header.Charset);
+    wxCSConv encConv(charset);
     if (!f.Open(po_file, encConv))
     {
         BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
     }
 
+    return charset;
+}
+
+// Returns key identifying duplicate items. Context is separated by EOT like
+// in MO files, so that "no context" differs from empty one.
+std::wstring MakeItemKey(const CatalogItem& item)
+{
+    std::wstring key;
+    if (item.HasContext())
+        key = str::to_wstring(item.GetContext()) + L'\x04';
+    key += str::to_wstring(item.GetRawString());
+    return key;
+}
+
+} // anonymous namespace
+
+
+void POCatalog::Load(const wxString& po_file, int flags)
+{
+    wxTextFile f;
+
+    Clear();
+    m_fileName = po_file;
+    m_header.BasePath = wxEmptyString;
+
+    wxString ext;
+    wxFileName::SplitPath(po_file, nullptr, nullptr, &ext);
+    if (ext.CmpNoCase("pot") == 0 || (flags & CreationFlag_IgnoreTranslations))
+        m_fileType = Type::POT;
+    else
+        m_fileType = Type::PO;
+
+    /* Load the .po file: */
+
+    m_header.Charset = OpenPOFile(f, po_file);
+
     if (!VerifyFileCharset(f, po_file, m_header.Charset))
     {
         wxLogError(_("There were errors when loading the file. Some data may be missing or corrupted as the result."));
@@ -958,6 +1130,21 @@ void POCatalog::Load(const wxString& po_file, int flags)
 }
 
 
+POCatalog::FileStatistics POCatalog::ReadFileStatistics(const wxString& po_file)
+{
+    wxTextFile f;
+    OpenPOFile(f, po_file);
+
+    POStatsParser parser(&f);
+    if (!parser.Parse() || !parser.FileIsValid)
+    {
+        BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
+    }
+
+    return parser.Stats;
+}
+
+
 void POCatalog::FixupCommonIssues()
 {
     if (m_header.Project == "PACKAGE VERSION")
@@ -1027,6 +1214,7 @@ void POCatalog::Clear()
 {
     // Catalog base class fields:
     m_items.clear();
+    InvalidateItemStates();
 
     // PO-specific fields:
     m_deletedItems.clear();
@@ -1157,7 +1345,7 @@ bool POCatalog::Save(const wxString& po_file, bool save_mo,
                 m_header.RevisionDate = currentTime;
             break;
         case Type::POT:
-            if ( m_fileType == Type::POT && !m_header.CreationDate.empty() )
+            if ( !m_keepCreationDate && !m_header.CreationDate.empty() )
                 m_header.CreationDate = currentTime;
             break;
 
@@ -1602,43 +1790,43 @@ bool POCatalog::HasWrongPluralFormsCount() const
 
 bool POCatalog::HasDuplicateItems() const
 {
-    typedef std::pair<wxString, wxString> MsgId;
-    std::set<MsgId> ids;
-    for (auto& item: m_items)
-    {
-        if (!ids.emplace(std::make_pair(item->GetContext(), item->GetRawString())).second)
-            return true;
-    }
-    return false;
+    return GetItemIndex().HasDuplicates();
 }
 
 bool POCatalog::FixDuplicateItems()
 {
-    auto oldname = m_fileName;
+    // Merge duplicates in memory, with the same results as msguniq would produce;
+    // conflicting translations are labeled the same way too:
+    const wxString label = !m_header.Project.empty() ? m_header.Project : wxFileName(m_fileName).GetFullName();
 
-    TempDirectory tmpdir;
-    if ( !tmpdir.IsOk() )
-        return false;
+    std::unordered_map<std::wstring, POCatalogItem*> seen;
+    seen.reserve(m_items.size());
 
-    wxString ext;
-    wxFileName::SplitPath(m_fileName, nullptr, nullptr, &ext);
-    wxString po_file_temp = tmpdir.CreateFileName("catalog." + ext);
-    wxString po_file_fixed = tmpdir.CreateFileName("fixed." + ext);
+    CatalogItemArray items;
+    items.reserve(m_items.size());
 
-    if ( !DoSaveOnly(po_file_temp, wxTextFileType_Unix) )
+    for (auto& i: m_items)
     {
-        wxLogError(_(L"Couldn’t save file %s."), po_file_temp.c_str());
-        return false;
+        auto item = std::static_pointer_cast<POCatalogItem>(i);
+        auto key = MakeItemKey(*item);
+        auto existing = seen.find(key);
+        if (existing != seen.end())
+        {
+            existing->second->MergeDuplicate(*item, label);
+        }
+        else
+        {
+            item->SetId((int)items.size() + 1);
+            items.push_back(item);
+            seen.emplace(std::move(key), item.get());
+        }
     }
 
-    GettextRunner().run_sync("msguniq", "-o", CliSafeFileName(po_file_fixed), CliSafeFileName(po_file_temp));
-
-    if (!wxFileName::FileExists(po_file_fixed))
-        return false;
-
-    Load(po_file_fixed);
-    m_fileName = oldname;
-    PostCreation();
+    if (items.size() != m_items.size())
+    {
+        m_items.swap(items);
+        InvalidateItemStates();
+    }
 
     return true;
 }
@@ -1721,9 +1909,18 @@ bool POCatalog::UpdateFromPOT(POCatalogPtr pot, bool replace_header)
         case Type::POT:
         {
             m_items = pot->m_items;
+            InvalidateItemStates();
             m_sourceLanguage = pot->m_sourceLanguage;
             m_sourceIsSymbolicID = pot->m_sourceIsSymbolicID;
             m_hasPluralItems = pot->m_hasPluralItems;
+
+            // the reference knows when its sources last changed, which is what
+            // POT-Creation-Date is about (msgmerge does the same for PO files):
+            if (!m_header.CreationDate.empty() && !pot->m_header.CreationDate.empty())
+            {
+                m_header.CreationDate = pot->m_header.CreationDate;
+                m_keepCreationDate = true;
+            }
             break;
         }
 
@@ -1747,6 +1944,41 @@ POCatalogPtr POCatalog::CreateFromPOT(POCatalogPtr pot)
         return nullptr;
 }
 
+POCatalogPtr POCatalog::CreateByConcatenating(const std::vector<POCatalogPtr>& parts)
+{
+    POCatalogPtr cat(new POCatalog(Type::POT));
+    if (!parts.empty())
+        cat->m_header = parts.front()->m_header;
+
+    // items already in the output, by context and msgid:
+    std::unordered_map<std::wstring, POCatalogItem*> seen;
+
+    for (auto& part: parts)
+    {
+        for (auto& i: part->m_items)
+        {
+            auto item = std::static_pointer_cast<POCatalogItem>(i);
+            auto key = MakeItemKey(*item);
+            auto existing = seen.find(key);
+            if (existing != seen.end())
+            {
+                existing->second->MergeDuplicate(*item);
+            }
+            else
+            {
+                item->SetId((int)cat->m_items.size() + 1);
+                cat->AddItem(item);
+                seen.emplace(std::move(key), item.get());
+            }
+        }
+
+        cat->m_hasPluralItems |= part->m_hasPluralItems;
+    }
+
+    cat->PostCreation();
+    return cat;
+}
+
 bool POCatalog::Merge(const POCatalogPtr& refcat)
 {
     wxString oldname = m_fileName;
@@ -46,6 +46,12 @@ protected:
     const wxArrayString& GetRawReferences() const { return m_references; }
     void SetRawReferences(const wxArrayString& ref) { m_references = ref; }
 
+    /// Merges a duplicate entry for the same msgid into this one, like msgcat does.
+    /// References, flags and comments are combined. Conflicting translations are
+    /// all kept, separated with markers containing @a label, and the item is
+    /// marked as fuzzy.
+    void MergeDuplicate(const POCatalogItem& other, const wxString& label = wxString());
+
     void UpdateInternalRepresentation() override {}
 
     friend class POLoadParser;
@@ -178,6 +184,23 @@ public:
     bool HasCapability(Cap cap) const override;
 
     static bool CanLoadFile(const wxString& extension);
+
+    /// Basic statistics of a PO file, see ReadFileStatistics()
+    struct FileStatistics
+    {
+        int all = 0;
+        int fuzzy = 0;
+        int untranslated = 0;
+        wxString revisionDate;
+    };
+
+    /**
+        Reads statistics of a PO file without loading it as a catalog, i.e.
+        without creating any items. Counts match GetStatistics() of the
+        loaded catalog, prior to any validation. Can be used from background
+        threads. Throws on errors, like loading the catalog would.
+     */
+    static FileStatistics ReadFileStatistics(const wxString& po_file);
     wxString GetPreferredExtension() const override;
 
     PluralFormsExpr GetPluralForms() const override;
@@ -216,6 +239,16 @@ public:
     void RemoveDeletedItems() override
         { m_deletedItems.clear(); }
 
+    /**
+        Creates POT catalog by concatenating @a parts, like msgcat does.
+
+        Items with the same context and msgid are merged into the first
+        occurrence (see POCatalogItem::MergeDuplicate()), otherwise the order
+        of items is preserved. Items of @a parts are reused, so the parts
+        shouldn't be used afterwards.
+     */
+    static POCatalogPtr CreateByConcatenating(const std::vector<POCatalogPtr>& parts);
+
     /// Updates the catalog from POT file.
     bool UpdateFromPOT(const wxString& pot_file, bool replace_header = false);
     bool UpdateFromPOT(POCatalogPtr pot, bool replace_header = false);
@@ -270,6 +303,10 @@ protected:
     int m_fileWrappingWidth;
     bool m_hasPluralItems = false;
 
+    /// POT-Creation-Date was taken from the reference in UpdateFromPOT() and
+    /// shouldn't be replaced with the current time when saving
+    bool m_keepCreationDate = false;
+
     friend class POLoadParser;
     friend class Catalog;
 };
@@ -34,7 +34,6 @@
 #include <wx/tokenzr.h> // FIXME
 
 #include <regex>
-#include <sstream>
 
 using namespace pugi;
 
@@ -71,12 +70,6 @@ QtLinguistReadException::QtLinguistReadException(const wxString& what)
 {}
 
 
-QtLinguistCatalogItem::document_lock::document_lock(QtLinguistCatalogItem *parent)
-    : std::lock_guard<std::mutex>(parent->m_owner.m_documentMutex)
-{
-}
-
-
 QtLinguistCatalogItem::QtLinguistCatalogItem(QtLinguistCatalog& owner, int itemId, xml_node node)
     : m_owner(owner), m_node(node)
 {
@@ -188,10 +181,11 @@ wxArrayString QtLinguistCatalogItem::GetReferences() const
 }
 
 
-void QtLinguistCatalogItem::UpdateInternalRepresentation()
+void QtLinguistCatalogItem::FlushToDocument()
 {
-    // modifications in the pugixml tree can affect other nodes, we must lock the entire document
-    document_lock lock(this);
+    if (!m_dirty)
+        return;
+    m_dirty = false;
 
     auto translation = m_node.child("translation");
 
@@ -331,12 +325,13 @@ bool QtLinguistCatalog::Save(const wxString& filename, bool /*save_mo*/,
         return false;
     }
 
+    FlushChangesToDocument();
+
     TempOutputFileFor tempfile(filename);
 
     // format_no_empty_element_tags (i.e. <translation></translation> is convention in .ts files
-    m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw | format_no_empty_element_tags);
-
-    if (!tempfile.Commit())
+    // write directly into the file, without serializing into memory first:
+    if (!m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw | format_no_empty_element_tags) || !tempfile.Commit())
     {
         wxLogError(_(L"Couldn’t save file %s."), filename.c_str());
         return false;
@@ -351,10 +346,17 @@ bool QtLinguistCatalog::Save(const wxString& filename, bool /*save_mo*/,
 
 std::string QtLinguistCatalog::SaveToBuffer()
 {
-    std::ostringstream s;
+    FlushChangesToDocument();
+
     // format_no_empty_element_tags (i.e. <translation></translation> is convention in .ts files
-    m_doc.save(s, "\t", format_raw | format_no_empty_element_tags);
-    return s.str();
+    return save_to_string(m_doc, format_raw | format_no_empty_element_tags);
+}
+
+
+void QtLinguistCatalog::FlushChangesToDocument()
+{
+    for (auto& i: m_items)
+        std::static_pointer_cast<QtLinguistCatalogItem>(i)->FlushToDocument();
 }
 
 
@@ -385,8 +387,6 @@ PluralFormsExpr QtLinguistCatalog::GetPluralForms() const
 
 void QtLinguistCatalog::RemoveDeletedItems()
 {
-    std::lock_guard<std::mutex> lock(m_documentMutex);
-
     const auto xpath_query = "//message[translation[@type='vanished' or @type='obsolete']]";
     for (auto& x: m_doc.select_nodes(xpath_query))
     {
@@ -32,7 +32,6 @@
 
 #include "pugixml.h"
 
-#include <mutex>
 #include <vector>
 
 
@@ -61,18 +60,19 @@ public:
     wxString GetRawSymbolicId() const override { return m_symbolicId; }
     wxArrayString GetReferences() const override;
 
-protected:
-    void UpdateInternalRepresentation() override;
+    /// Writes changes made to the item into the XML document, if there are any
+    void FlushToDocument();
 
-    struct document_lock : public std::lock_guard<std::mutex>
-    {
-        document_lock(QtLinguistCatalogItem *parent);
-    };
+protected:
+    // Modifications of the pugixml tree can affect other nodes, so the tree
+    // is only updated in FlushToDocument() when saving.
+    void UpdateInternalRepresentation() override { m_dirty = true; }
 
 protected:
     QtLinguistCatalog& m_owner;
     pugi::xml_node m_node;
     wxString m_symbolicId;
+    bool m_dirty = false;
 };
 
 
@@ -113,8 +113,10 @@ protected:
     void Parse(pugi::xml_node root);
     void ParseSubtree(int& id, pugi::xml_node root, const wxString& context);
 
+    /// Writes changes made to items into m_doc
+    void FlushChangesToDocument();
+
 protected:
-    std::mutex m_documentMutex;
     pugi::xml_document m_doc;
 
     Language m_language;
@@ -36,7 +36,6 @@
 
 #include <memory>
 #include <set>
-#include <sstream>
 
 using namespace pugi;
 
@@ -67,12 +66,6 @@ RESXReadException::RESXReadException(const wxString& what)
 {}
 
 
-RESXCatalogItem::document_lock::document_lock(RESXCatalogItem *parent)
-    : std::lock_guard<std::mutex>(parent->m_owner.m_documentMutex)
-{
-}
-
-
 RESXCatalogItem::RESXCatalogItem(RESXCatalog& owner, int itemId, xml_node node) 
     : m_owner(owner), m_node(node)
 {
@@ -109,13 +102,14 @@ RESXCatalogItem::RESXCatalogItem(RESXCatalog& owner, int itemId, xml_node node)
 }
 
 
-void RESXCatalogItem::UpdateInternalRepresentation()
+void RESXCatalogItem::FlushToDocument()
 {
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
     wxASSERT(m_translations.size() == 1); // RESX doesn't support plurals
-    
-    // modifications in the pugixml tree can affect other nodes, we must lock the entire document
-    document_lock lock(this);
-    
+
     auto value = m_node.child("value");
     if (!value)
         value = m_node.append_child("value");
@@ -200,11 +194,12 @@ bool RESXCatalog::Save(const wxString& filename, bool /*save_mo*/,
         return false;
     }
 
-    TempOutputFileFor tempfile(filename);
+    FlushChangesToDocument();
 
-    m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw);
+    TempOutputFileFor tempfile(filename);
 
-    if (!tempfile.Commit())
+    // write directly into the file, without serializing into memory first:
+    if (!m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw) || !tempfile.Commit())
     {
         wxLogError(_(L"Couldn’t save file %s."), filename.c_str());
         return false;
@@ -219,9 +214,16 @@ bool RESXCatalog::Save(const wxString& filename, bool /*save_mo*/,
 
 std::string RESXCatalog::SaveToBuffer()
 {
-    std::ostringstream s;
-    m_doc.save(s, "\t", format_raw);
-    return s.str();
+    FlushChangesToDocument();
+
+    return save_to_string(m_doc, format_raw);
+}
+
+
+void RESXCatalog::FlushChangesToDocument()
+{
+    for (auto& i: m_items)
+        std::static_pointer_cast<RESXCatalogItem>(i)->FlushToDocument();
 }
 
 
@@ -31,7 +31,6 @@
 
 #include "pugixml.h"
 
-#include <mutex>
 #include <vector>
 
 
@@ -60,18 +59,19 @@ public:
     wxString GetRawSymbolicId() const override { return m_symbolicId; }
     wxArrayString GetReferences() const override { return wxArrayString(); }
 
-protected:
-    void UpdateInternalRepresentation() override;
+    /// Writes changes made to the item into the XML document, if there are any
+    void FlushToDocument();
 
-    struct document_lock : public std::lock_guard<std::mutex>
-    {
-        document_lock(RESXCatalogItem *parent);
-    };
+protected:
+    // Modifications of the pugixml tree can affect other nodes, so the tree
+    // is only updated in FlushToDocument() when saving.
+    void UpdateInternalRepresentation() override { m_dirty = true; }
 
 protected:
     RESXCatalog& m_owner;
     pugi::xml_node m_node;
     wxString m_symbolicId;
+    bool m_dirty = false;
 };
 
 
@@ -106,8 +106,10 @@ protected:
 
     void Parse(pugi::xml_node root);
 
+    /// Writes changes made to items into m_doc
+    void FlushChangesToDocument();
+
 protected:
-    std::mutex m_documentMutex;
     pugi::xml_document m_doc;
     Language m_language;
 
@@ -25,6 +25,7 @@
 
 #include "catalog_xliff.h"
 
+#include "concurrency.h"
 #include "configuration.h"
 #include "str_helpers.h"
 #include "utility.h"
@@ -37,7 +38,6 @@
 #include <charconv>
 #include <memory>
 #include <set>
-#include <sstream>
 
 using namespace pugi;
 
@@ -75,17 +75,17 @@ inline bool is_self_closing(xml_node node)
 
 inline std::string get_node_markup(xml_node node)
 {
-    std::ostringstream s;
+    xml_string_writer s;
     node.print(s, "", format_raw);
-    return s.str();
+    return std::move(s.result);
 }
 
 std::string get_subtree_markup(xml_node node)
 {
-    std::ostringstream s;
+    xml_string_writer s;
     for (auto c: node.children())
         c.print(s, "", format_raw);
-    return s.str();
+    return std::move(s.result);
 }
 
 inline std::string get_node_text_or_markup(xml_node node, bool isPlainText)
@@ -138,6 +138,20 @@ bool set_node_text_with_metadata(xml_node node, std::string&& text, const XLIFFS
     }
 }
 
+/// Checks if set_node_text_with_metadata() would succeed for given text, without modifying any document
+bool is_valid_text_with_metadata(std::string&& text, const XLIFFStringMetadata& metadata)
+{
+    if (metadata.isPlainText)
+        return true;
+
+    for (auto& ph: metadata.substitutions)
+        boost::replace_all(text, ph.placeholder, ph.markup);
+
+    xml_document doc;
+    auto result = doc.load_buffer(text.c_str(), text.size(), PUGI_PARSE_FLAGS, encoding_utf8);
+    return result.status == status_ok || result.status == status_no_document_element;
+}
+
 /// Check if a string contains only digit (e.g. "42")
 inline bool is_numeric_only(const std::string& s)
 {
@@ -407,9 +421,17 @@ XLIFFReadException::XLIFFReadException(const wxString& what)
 {}
 
 
-XLIFFCatalogItem::document_lock::document_lock(XLIFFCatalogItem *parent)
-    : std::lock_guard<std::mutex>(parent->m_owner.m_documentMutex)
+void XLIFFCatalogItem::UpdateInternalRepresentation()
 {
+    m_dirty = true;
+
+    // check the markup immediately, so that the error is shown while editing:
+    auto trans = GetTranslation();
+    if (!trans.empty() && !is_valid_text_with_metadata(str::to_utf8(trans), m_metadata))
+    {
+        // TRANSLATORS: Shown as error if a translation of XLIFF markup is not valid XML
+        SetIssue(Issue::Error, _("Broken markup in translation string."));
+    }
 }
 
 
@@ -438,6 +460,8 @@ bool XLIFFCatalog::CanLoadFile(const wxString& extension)
 
 std::shared_ptr<XLIFFCatalog> XLIFFCatalog::OpenImpl(const wxString& filename, InstanceCreatorImpl& creator)
 {
+    // load_file() reads the file into a single buffer owned by the document and parses
+    // it in place, i.e. node values point into it and aren't copied:
     xml_document doc;
     auto result = doc.load_file(filename.fn_str(), PUGI_PARSE_FLAGS);
     if (!result)
@@ -491,11 +515,12 @@ bool XLIFFCatalog::Save(const wxString& filename, bool /*save_mo*/,
         return false;
     }
 
-    TempOutputFileFor tempfile(filename);
+    FlushChangesToDocument();
 
-    m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw);
+    TempOutputFileFor tempfile(filename);
 
-    if ( !tempfile.Commit() )
+    // write directly into the file, without serializing into memory first:
+    if (!m_doc.save_file(tempfile.FileName().fn_str(), "\t", format_raw) || !tempfile.Commit())
     {
         wxLogError(_(L"Couldn’t save file %s."), filename.c_str());
         return false;
@@ -510,9 +535,16 @@ bool XLIFFCatalog::Save(const wxString& filename, bool /*save_mo*/,
 
 std::string XLIFFCatalog::SaveToBuffer()
 {
-    std::ostringstream s;
-    m_doc.save(s, "\t", format_raw);
-    return s.str();
+    FlushChangesToDocument();
+
+    return save_to_string(m_doc, format_raw);
+}
+
+
+void XLIFFCatalog::FlushChangesToDocument()
+{
+    for (auto& i: m_items)
+        std::static_pointer_cast<XLIFFCatalogItem>(i)->FlushToDocument();
 }
 
 
@@ -590,13 +622,10 @@ public:
         ParseLengthConstraint(node.attribute("minwidth").value(), sizeUnit, m_string.length(), &m_minLength);
     }
 
-    void UpdateInternalRepresentation() override
+    void WriteToDocument() override
     {
         wxASSERT( m_translations.size() == 1 ); // no plurals
 
-        // modifications in the pugixml tree can affect other nodes, we must lock the entire document
-        document_lock lock(this);
-
         auto target = m_node.child("target");
         if (!target)
         {
@@ -613,11 +642,8 @@ public:
         auto trans = GetTranslation();
         if (!trans.empty())
         {
-            if (!set_node_text_with_metadata(target, str::to_utf8(trans), m_metadata))
-            {
-                // TRANSLATORS: Shown as error if a translation of XLIFF markup is not valid XML
-                SetIssue(Issue::Error, _("Broken markup in translation string."));
-            }
+            // invalid markup was already reported by UpdateInternalRepresentation()
+            set_node_text_with_metadata(target, str::to_utf8(trans), m_metadata);
         }
         else // no translation
         {
@@ -707,8 +733,8 @@ public:
 
 void XLIFF1Catalog::Parse(pugi::xml_node root)
 {
-    int id = 0;
     bool extractedLanguage = false;
+    std::vector<xml_node> units;
 
     for (auto file: root.children("file"))
     {
@@ -727,13 +753,23 @@ void XLIFF1Catalog::Parse(pugi::xml_node root)
             auto node = unit.node();
             if (strcmp(node.attribute("translate").value(), "no") == 0)
                 continue;
+            units.push_back(node);
+        }
+    }
 
+    // Creating items is relatively expensive, so do it in parallel. This is
+    // safe, because the document is only read at this point.
+    m_items.resize(units.size());
+    dispatch::parallel_for(units.size(), 256, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
             if (m_subversion == 0)
-                m_items.push_back(std::make_shared<XLIFF10CatalogItem>(*this, ++id, node));
+                m_items[i] = std::make_shared<XLIFF10CatalogItem>(*this, int(i + 1), units[i]);
             else
-                m_items.push_back(std::make_shared<XLIFF12CatalogItem>(*this, ++id, node));
+                m_items[i] = std::make_shared<XLIFF12CatalogItem>(*this, int(i + 1), units[i]);
         }
-    }
+    });
 }
 
 
@@ -800,13 +836,10 @@ public:
         }
     }
 
-    void UpdateInternalRepresentation() override
+    void WriteToDocument() override
     {
         wxASSERT( m_translations.size() == 1 ); // no plurals
 
-        // modifications in the pugixml tree can affect other nodes, we must lock the entire document
-        document_lock lock(this);
-
         auto target = m_node.child("target");
         if (!target)
         {
@@ -827,11 +860,8 @@ public:
             else
                 m_node.remove_attribute("subState");
 
-            if (!set_node_text_with_metadata(target, str::to_utf8(trans), m_metadata))
-            {
-                // TRANSLATORS: Shown as error if a translation of XLIFF markup is not valid XML
-                SetIssue(Issue::Error, _("Broken markup in translation string."));
-            }
+            // invalid markup was already reported by UpdateInternalRepresentation()
+            set_node_text_with_metadata(target, str::to_utf8(trans), m_metadata);
         }
         else // no translation
         {
@@ -865,15 +895,22 @@ void XLIFF2Catalog::Parse(pugi::xml_node root)
     m_sourceLanguage = Language::FromLanguageTag(root.attribute("srcLang").value());
     m_language = Language::FromLanguageTag(root.attribute("trgLang").value());
 
-    int id = 0;
+    std::vector<xml_node> segments;
     for (auto segment: root.select_nodes(".//segment"))
     {
         auto node = segment.node();
         if (strcmp(node.parent().attribute("translate").value(), "no") == 0)
             continue;
-
-        m_items.push_back(std::make_shared<XLIFF2CatalogItem>(*this, ++id, node));
+        segments.push_back(node);
     }
+
+    // see XLIFF1Catalog::Parse()
+    m_items.resize(segments.size());
+    dispatch::parallel_for(segments.size(), 256, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            m_items[i] = std::make_shared<XLIFF2CatalogItem>(*this, int(i + 1), segments[i]);
+    });
 }
 
 
@@ -31,7 +31,6 @@
 
 #include "pugixml.h"
 
-#include <mutex>
 #include <vector>
 
 
@@ -80,17 +79,29 @@ public:
 
     wxString GetRawSymbolicId() const override { return m_symbolicId; }
 
-protected:
-    struct document_lock : public std::lock_guard<std::mutex>
+    /// Writes changes made to the item into the XML document, if there are any
+    void FlushToDocument()
     {
-        document_lock(XLIFFCatalogItem *parent);
-    };
+        if (!m_dirty)
+            return;
+        m_dirty = false;
+        WriteToDocument();
+    }
+
+protected:
+    // Modifications of the pugixml tree can affect other nodes, so the tree
+    // is only updated in FlushToDocument() when saving. This way, items can
+    // be modified concurrently without locking the entire document.
+    void UpdateInternalRepresentation() override;
+
+    virtual void WriteToDocument() = 0;
 
 protected:
     XLIFFCatalog& m_owner;
     pugi::xml_node m_node;
     XLIFFStringMetadata m_metadata;
     wxString m_symbolicId;
+    bool m_dirty = false;
 };
 
 
@@ -132,8 +143,10 @@ protected:
 
     virtual void Parse(pugi::xml_node root) = 0;
 
+    /// Writes changes made to items into m_doc
+    void FlushChangesToDocument();
+
 protected:
-    std::mutex m_documentMutex;
     pugi::xml_document m_doc;
     Language m_language;
 
@@ -71,9 +71,14 @@
     #endif
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <type_traits>
 
 #include <wx/app.h>
@@ -653,6 +658,145 @@ inline auto on_main(F&& f) -> future<typename detail::future_unwrapper<typename
 
 
 
+namespace detail
+{
+
+// Shared state of parallel_for(); helpers that start after all chunks were
+// claimed just exit, so it's kept alive by them and not the caller's stack
+struct parallel_for_state
+{
+    std::function<void(size_t, size_t)> func;
+    size_t count = 0, chunk_size = 0, chunks = 0;
+    std::atomic<size_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t done = 0;
+    std::exception_ptr error;
+
+    bool run_one()
+    {
+        const size_t c = next.fetch_add(1, std::memory_order_relaxed);
+        if (c >= chunks)
+            return false;
+
+        const size_t begin = c * chunk_size;
+        try
+        {
+            func(begin, std::min(count, begin + chunk_size));
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (++done == chunks)
+            cv.notify_all();
+        return true;
+    }
+};
+
+} // namespace detail
+
+
+/**
+    Process range [0, count) in parallel on the background pool.
+
+    The range is split into contiguous chunks of at least @a min_chunk
+    elements and @a f(begin, end) is called once for each of them. The calling
+    thread participates in processing, so it is safe to use from within
+    background tasks too. Returns when all chunks were processed and rethrows
+    the first exception thrown by @a f, if any.
+
+    The order in which chunks are processed is unspecified; @a f must only
+    modify state owned by its range to keep results deterministic.
+ */
+template<typename F>
+void parallel_for(size_t count, size_t min_chunk, F&& f)
+{
+    if (count == 0)
+        return;
+
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    // use more chunks than threads for better balancing of uneven workloads:
+    const size_t chunk_size = std::max(std::max<size_t>(min_chunk, 1), (count + threads * 4 - 1) / (threads * 4));
+    const size_t chunks = (count + chunk_size - 1) / chunk_size;
+
+    if (chunks == 1)
+    {
+        f(size_t(0), count);
+        return;
+    }
+
+    auto st = std::make_shared<detail::parallel_for_state>();
+    st->func = std::forward<F>(f);
+    st->count = count;
+    st->chunk_size = chunk_size;
+    st->chunks = chunks;
+
+    const size_t helpers = std::min(threads, chunks) - 1;
+    for (size_t i = 0; i < helpers; i++)
+        detail::background_queue_executor::get().submit([st]{ while (st->run_one()) {} });
+
+    while (st->run_one()) {}
+
+    std::unique_lock<std::mutex> lock(st->mutex);
+    st->cv.wait(lock, [&st]{ return st->done == st->chunks; });
+
+    if (st->error)
+        std::rethrow_exception(st->error);
+}
+
+
+/**
+    Sort range [first, last) using the background pool.
+
+    Ranges shorter than 2 * @a min_chunk are sorted with std::sort() on the
+    calling thread. Larger ones are split into runs that are sorted in
+    parallel and then merged pairwise. @a comp must be safe to call
+    concurrently. Like std::sort(), the sort is not stable.
+ */
+template<typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp, size_t min_chunk = 10000)
+{
+    const size_t count = last - first;
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 1 || count < 2 * std::max<size_t>(min_chunk, 1))
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    const size_t runs = std::min(threads, count / min_chunk);
+    const size_t run_size = (count + runs - 1) / runs;
+
+    parallel_for(runs, 1, [=](size_t begin, size_t end)
+    {
+        for (size_t r = begin; r < end; r++)
+            std::sort(first + r * run_size, first + std::min(count, (r + 1) * run_size), comp);
+    });
+
+    for (size_t width = run_size; width < count; width *= 2)
+    {
+        parallel_for((count + 2 * width - 1) / (2 * width), 1, [=](size_t begin, size_t end)
+        {
+            for (size_t p = begin; p < end; p++)
+            {
+                const size_t lo = p * 2 * width;
+                const size_t mid = std::min(count, lo + width);
+                const size_t hi = std::min(count, lo + 2 * width);
+                if (mid < hi)
+                    std::inplace_merge(first + lo, first + mid, first + hi, comp);
+            }
+        });
+    }
+}
+
+
+
 /// Helper exception for when the task was cancelled via cancellation_token
 class cancellation_exception : public std::exception
 {
@@ -70,6 +70,10 @@ public:
     static bool ShowWarnings() { return Read("/show_warnings", true); }
     static void ShowWarnings(bool show) { Write("/show_warnings", show); }
 
+    /// Number of concurrently running extraction processes; 0 means automatic
+    static int ExtractionJobs() { return (int)Read("/extraction_jobs", (long)0); }
+    static void ExtractionJobs(int jobs) { Write("/extraction_jobs", (long)jobs); }
+
     static std::string CloudLastProject() { return Read("/cloud_last_project", std::string()); }
     static void CloudLastProject(const std::string& prj) { return Write("/cloud_last_project", prj); }
 
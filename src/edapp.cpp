@@ -520,6 +520,7 @@ int PoeditApp::OnExit()
     FileMonitor::CleanUp();
     ColorScheme::CleanUp();
     RecentFiles::CleanUp();
+    SuggestionsBackendRegistry::CleanUp();
     TranslationMemory::CleanUp();
 
 #ifdef HAS_UPDATES_CHECK
@@ -323,6 +323,11 @@ BEGIN_EVENT_TABLE(PoeditFrame, wxFrame)
    EVT_MENU           (XRCID("sort_group_by_context"), PoeditFrame::OnSortGroupByContext)
    EVT_MENU           (XRCID("sort_untrans_first"), PoeditFrame::OnSortUntranslatedFirst)
    EVT_MENU           (XRCID("sort_errors_first"), PoeditFrame::OnSortErrorsFirst)
+   EVT_MENU           (XRCID("filter_all"), PoeditFrame::OnFilter)
+   EVT_MENU           (XRCID("filter_unfinished"), PoeditFrame::OnFilter)
+   EVT_MENU           (XRCID("filter_untranslated"), PoeditFrame::OnFilter)
+   EVT_MENU           (XRCID("filter_fuzzy"), PoeditFrame::OnFilter)
+   EVT_MENU           (XRCID("filter_errors"), PoeditFrame::OnFilter)
    EVT_MENU           (XRCID("show_sidebar"),      PoeditFrame::OnShowHideSidebar)
    EVT_UPDATE_UI      (XRCID("show_sidebar"),      PoeditFrame::OnUpdateShowHideSidebar)
    EVT_MENU           (XRCID("show_statusbar"),    PoeditFrame::OnShowHideStatusbar)
@@ -776,6 +781,8 @@ void PoeditFrame::PlaceInitialFocus(int lineno)
         {
             item = m_catalog->FindItemIndexByLine(lineno);
             item = (item == -1) ? 0 : m_list->CatalogIndexToList(item);
+            if (item == -1)
+                item = 0; // filtered out
         }
         m_list->SelectAndFocus(item);
     }
@@ -1843,7 +1850,7 @@ Catalog::ValidationResults PoeditFrame::ValidateCurrentFile()
     auto results = m_catalog->Validate();
 
     if (m_list && m_list->sortOrder().errorsFirst)
-        m_list->Sort();
+        m_list->SortChangedItems();
     else
         m_list->RefreshAllItems();
 
@@ -2555,6 +2562,31 @@ void PoeditFrame::MarkAsModified()
 }
 
 
+void PoeditFrame::NotifyItemsChanged(const std::vector<int>& indexes)
+{
+    if (!m_catalog || indexes.empty())
+        return;
+
+    // re-check only the changed items, their issues were reset:
+    m_catalog->ValidateItems(indexes);
+
+    MarkAsModified();
+    if (m_list)
+        m_list->RefreshCatalogItems(indexes);
+    UpdateStatusBar();
+
+    auto current = GetCurrentItem();
+    for (int i: indexes)
+    {
+        if ((*m_catalog)[i] == current)
+        {
+            UpdateToTextCtrl(EditingArea::UndoableEdit);
+            break;
+        }
+    }
+}
+
+
 void PoeditFrame::RefreshControls(int flags)
 {
     if (!m_catalog)
@@ -2743,6 +2775,37 @@ void PoeditFrame::UpdateMenu()
     menubar->Enable(XRCID("sort_untrans_first"), editable);
     menubar->Enable(XRCID("sort_errors_first"), editable);
 
+    menubar->Enable(XRCID("filter_all"), nonEmpty);
+    menubar->Enable(XRCID("filter_unfinished"), editable);
+    menubar->Enable(XRCID("filter_untranslated"), editable);
+    menubar->Enable(XRCID("filter_fuzzy"), editable);
+    menubar->Enable(XRCID("filter_errors"), editable);
+
+    if (m_list)
+    {
+        // search results of "Find all" don't have a menu item, they are a view of all entries:
+        const char *filterItem = "filter_all";
+        switch (m_list->GetFilter())
+        {
+            case PoeditListCtrl::Filter::All:
+            case PoeditListCtrl::Filter::Search:
+                break;
+            case PoeditListCtrl::Filter::Unfinished:
+                filterItem = "filter_unfinished";
+                break;
+            case PoeditListCtrl::Filter::Untranslated:
+                filterItem = "filter_untranslated";
+                break;
+            case PoeditListCtrl::Filter::Fuzzy:
+                filterItem = "filter_fuzzy";
+                break;
+            case PoeditListCtrl::Filter::Errors:
+                filterItem = "filter_errors";
+                break;
+        }
+        menubar->Check(XRCID(filterItem), true);
+    }
+
     if (m_list)
         m_list->Enable(nonEmpty);
 
@@ -2863,7 +2926,7 @@ void PoeditFrame::WriteCatalog(const wxString& catalog, TFunctor completionHandl
         tmUpdateThread.wait();
 
     if (m_list && m_list->sortOrder().errorsFirst)
-        m_list->Sort();
+        m_list->SortChangedItems();
 
     if (validation_results.errors)
     {
@@ -3236,6 +3299,23 @@ void PoeditFrame::OnSortErrorsFirst(wxCommandEvent& event)
 }
 
 
+void PoeditFrame::OnFilter(wxCommandEvent& event)
+{
+    auto filter = PoeditListCtrl::Filter::All;
+    if (event.GetId() == XRCID("filter_unfinished"))
+        filter = PoeditListCtrl::Filter::Unfinished;
+    else if (event.GetId() == XRCID("filter_untranslated"))
+        filter = PoeditListCtrl::Filter::Untranslated;
+    else if (event.GetId() == XRCID("filter_fuzzy"))
+        filter = PoeditListCtrl::Filter::Fuzzy;
+    else if (event.GetId() == XRCID("filter_errors"))
+        filter = PoeditListCtrl::Filter::Errors;
+
+    m_list->SetFilter(filter);
+    UpdateMenu();
+}
+
+
 void PoeditFrame::OnShowHideSidebar(wxCommandEvent&)
 {
     bool toShow = !m_sidebarSplitter->IsSplit();
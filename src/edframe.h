@@ -127,6 +127,12 @@ class PoeditFrame : public PoeditFrameBase
 
         void MarkAsModified();
 
+        /// Updates the UI after bulk changes to many items, identified by catalog index
+        void NotifyItemsChanged(const std::vector<int>& indexes);
+
+        /// Updates the UI after the list's filter was changed from outside of the frame
+        void NotifyFilterChanged() { UpdateMenu(); }
+
         /** Updates catalog and sets m_modified flag. Updates from POT
             if \a pot_file is not empty and from sources otherwise.
          */
@@ -308,6 +314,7 @@ private:
         void OnSortGroupByContext(wxCommandEvent&);
         void OnSortUntranslatedFirst(wxCommandEvent&);
         void OnSortErrorsFirst(wxCommandEvent&);
+        void OnFilter(wxCommandEvent&);
 
         void OnShowHideSidebar(wxCommandEvent& event);
         void OnUpdateShowHideSidebar(wxUpdateUIEvent& event);
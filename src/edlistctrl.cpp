@@ -30,6 +30,7 @@
 #include "language.h"
 #include "cat_sorting.h"
 #include "colorscheme.h"
+#include "concurrency.h"
 #include "unicode_helpers.h"
 #include "utility.h"
 
@@ -77,6 +78,8 @@ public:
         if (focus != -1)
         {
             auto item = list->CatalogIndexToListItem(focus);
+            if (!item.IsOk())
+                return; // filtered out
             list->EnsureVisible(item);
             list->SetCurrentItem(item);
         }
@@ -259,6 +262,8 @@ PoeditListCtrl::Model::Model(TextDirection appTextDir)
 
 void PoeditListCtrl::Model::SetVisualMode(ColorScheme::Mode visualMode)
 {
+    InvalidateRowCache();
+
     m_clrID = ColorScheme::Get(Color::ItemID, visualMode);
     m_clrFuzzy = ColorScheme::Get(Color::ItemFuzzy, visualMode);
     m_clrInvalid = ColorScheme::Get(Color::ItemError, visualMode);
@@ -274,12 +279,17 @@ void PoeditListCtrl::Model::SetVisualMode(ColorScheme::Mode visualMode)
 void PoeditListCtrl::Model::SetCatalog(CatalogPtr catalog)
 {
     m_catalog = catalog;
+    InvalidateRowCache();
 
     if (!catalog)
     {
         Reset(0);
+        m_sortedIndexes.clear();
+        m_sortRank.clear();
         m_mapListToCatalog.clear();
         m_mapCatalogToList.clear();
+        m_comparator.reset();
+        m_changedSinceSort.clear();
         return;
     }
 
@@ -288,10 +298,17 @@ void PoeditListCtrl::Model::SetCatalog(CatalogPtr catalog)
     m_sourceTextDir = srclang.Direction();
     m_transTextDir = lang.Direction();
 
+    // search results are meaningless for a different catalog:
+    if (m_filter == Filter::Search)
+    {
+        m_filter = Filter::All;
+        m_searchResults.clear();
+    }
+
     // sort catalog items, create indexes mapping
     CreateSortMap();
 
-    Reset(catalog->GetCount());
+    Reset((unsigned)m_mapListToCatalog.size());
 }
 
 
@@ -300,7 +317,153 @@ void PoeditListCtrl::Model::UpdateSort()
     if (!m_catalog)
         return;
     CreateSortMap();
-    Reset(m_catalog->GetCount());
+    Reset((unsigned)m_mapListToCatalog.size());
+}
+
+
+void PoeditListCtrl::Model::SetFilter(Filter filter, std::vector<int> searchResults)
+{
+    m_filter = filter;
+    m_searchResults = std::move(searchResults);
+
+    if (!m_catalog)
+        return;
+
+    ApplyFilter();
+    Reset((unsigned)m_mapListToCatalog.size());
+}
+
+
+void PoeditListCtrl::Model::ApplyFilter()
+{
+    const int count = (int)m_sortedIndexes.size();
+
+    // forget rows of previously shown items:
+    if ((int)m_mapCatalogToList.size() != count)
+    {
+        m_mapCatalogToList.assign(count, -1);
+    }
+    else
+    {
+        for (int i: m_mapListToCatalog)
+            m_mapCatalogToList[i] = -1;
+    }
+
+    CatalogItemStates::State state = CatalogItemStates::Unfinished;
+    switch (m_filter)
+    {
+        case Filter::All:
+            m_mapListToCatalog = m_sortedIndexes;
+            break;
+
+        case Filter::Search:
+            m_mapListToCatalog.clear();
+            for (int i: m_searchResults)
+            {
+                if (i >= 0 && i < count)
+                    m_mapListToCatalog.push_back(i);
+            }
+            break;
+
+        case Filter::Untranslated:
+            state = CatalogItemStates::Untranslated;
+            break;
+        case Filter::Fuzzy:
+            state = CatalogItemStates::Fuzzy;
+            break;
+        case Filter::Unfinished:
+            state = CatalogItemStates::Unfinished;
+            break;
+        case Filter::Errors:
+            state = CatalogItemStates::Error;
+            break;
+    }
+
+    if (m_filter != Filter::All)
+    {
+        // Matching items are obtained from the states bitsets, cost depends on
+        // their number rather than catalog size. Put them into sort order:
+        if (m_filter != Filter::Search)
+            m_mapListToCatalog = m_catalog->GetItemStates().GetItems(state);
+        std::sort(m_mapListToCatalog.begin(), m_mapListToCatalog.end(),
+                  [this](int a, int b){ return m_sortRank[a] < m_sortRank[b]; });
+    }
+
+    for (int row = 0; row < (int)m_mapListToCatalog.size(); row++)
+        m_mapCatalogToList[m_mapListToCatalog[row]] = row;
+}
+
+
+void PoeditListCtrl::Model::UpdateSortOfChangedItems()
+{
+    if (!m_catalog)
+        return;
+
+    const int count = (int)m_catalog->GetCount();
+    if (!m_comparator || count != (int)m_sortedIndexes.size())
+    {
+        UpdateSort();
+        return;
+    }
+
+    // Re-evaluating flags (errors etc.) is cheap, so do it for all items, but
+    // only recompute collation keys of items known to be modified:
+    std::vector<int> moved;
+    std::vector<bool> isMoved(count, false);
+    for (int i = 0; i < count; i++)
+    {
+        if (m_comparator->UpdateItem(i, m_changedSinceSort[i]))
+        {
+            moved.push_back(i);
+            isMoved[i] = true;
+        }
+    }
+    m_changedSinceSort.assign(count, false);
+
+    if (moved.empty())
+    {
+        // state changes may still affect filtered view:
+        if (m_filter != Filter::All && m_filter != Filter::Search)
+        {
+            auto visible = m_mapListToCatalog;
+            ApplyFilter();
+            if (visible != m_mapListToCatalog)
+                Reset((unsigned)m_mapListToCatalog.size());
+        }
+        return;
+    }
+
+    // The remaining items are still in correct order; take the changed ones out
+    // and put them back into their new positions.
+    auto& list = m_sortedIndexes;
+    list.erase(std::remove_if(list.begin(), list.end(), [&isMoved](int i){ return isMoved[i]; }), list.end());
+
+    auto& comparator = *m_comparator;
+    std::sort(moved.begin(), moved.end(), std::cref(comparator));
+
+    if (moved.size() < 64)
+    {
+        // binary search; as the moved items are sorted, each can start after the previous one
+        auto from = list.begin();
+        for (int i: moved)
+        {
+            from = std::lower_bound(from, list.end(), i, std::cref(comparator));
+            from = list.insert(from, i) + 1;
+        }
+    }
+    else
+    {
+        const auto middle = list.insert(list.end(), moved.begin(), moved.end());
+        std::inplace_merge(list.begin(), middle, list.end(), std::cref(comparator));
+    }
+
+    for (int i = 0; i < count; i++)
+        m_sortRank[m_sortedIndexes[i]] = i;
+    ApplyFilter();
+
+    wxLogTrace("poedit", "repositioned %d changed items in the list", (int)moved.size());
+
+    Reset((unsigned)m_mapListToCatalog.size());
 }
 
 
@@ -387,58 +550,25 @@ void PoeditListCtrl::Model::GetValueByRow(wxVariant& variant, unsigned row, unsi
 
         case Col_Source:
         {
-            wxString orig;
-            const auto orig_str = TrimTextValue(d->GetString(), m_maxVisibleWidth);
-
-        #ifdef __WXMSW__
-            // Temporary workaround for https://github.com/vslavik/poedit/issues/343 and
-            // https://github.com/vslavik/poedit/issues/481 -- fall back to old style rendering:
-            if (m_appTextDir == TextDirection::RTL && m_sourceTextDir == TextDirection::LTR)
+            auto& cached = CachedRow(CatalogIndex(row), *d);
+            if (!cached.hasSource)
             {
-                // non-markup rendering of source column:
-                if (d->HasContext())
-                    orig.Printf("[%s] %s", d->GetContext(), orig_str);
-                else
-                    orig = orig_str;
-            }
-            else
-        #endif
-            {
-                if (d->HasContext())
-                {
-                    // Work around a problem with GTK+'s coloring of markup that begins with colorizing <span>:
-                #ifdef __WXGTK__
-                    #define MARKUP(x) L"\u200B" L##x
-                #else
-                    #define MARKUP(x) x
-                #endif
-                    orig.Printf(MARKUP("<span bgcolor=\"%s\" color=\"%s\"> %s | </span> %s"),
-                        m_clrContextBg, m_clrContextFg,
-                        EscapeMarkup(d->GetContext()), EscapeMarkup(orig_str));
-                }
-                else
-                {
-                    orig = EscapeMarkup(orig_str);
-                }
+                cached.source = FormatSource(*d);
+                cached.hasSource = true;
             }
-
-            // Add RTL Unicode mark to render bidi texts correctly
-            if (m_appTextDir != m_sourceTextDir)
-                variant = bidi::mark_direction(orig, m_sourceTextDir);
-            else
-                variant = orig;
+            variant = cached.source;
             break;
         }
 
         case Col_Translation:
         {
-            const auto trans = TrimTextValue(d->GetTranslation(), m_maxVisibleWidth);
-
-            // Add RTL Unicode mark to render bidi texts correctly
-            if (m_appTextDir != m_transTextDir)
-                variant = bidi::mark_direction(trans, m_transTextDir);
-            else
-                variant = trans;
+            auto& cached = CachedRow(CatalogIndex(row), *d);
+            if (!cached.hasTranslation)
+            {
+                cached.translation = FormatTranslation(*d);
+                cached.hasTranslation = true;
+            }
+            variant = cached.translation;
             break;
         }
 
@@ -448,6 +578,98 @@ void PoeditListCtrl::Model::GetValueByRow(wxVariant& variant, unsigned row, unsi
     };
 }
 
+PoeditListCtrl::Model::RowCacheEntry& PoeditListCtrl::Model::CachedRow(int index, const CatalogItem& item) const
+{
+    if (m_rowCache.empty())
+        m_rowCache.resize(ROW_CACHE_SIZE);
+
+    auto& e = m_rowCache[index % ROW_CACHE_SIZE];
+    if (e.index == index && e.item == &item && e.generation == item.GetGeneration())
+    {
+        m_rowCacheHits++;
+    }
+    else
+    {
+        m_rowCacheMisses++;
+        e.index = index;
+        e.item = &item;
+        e.generation = item.GetGeneration();
+        e.hasSource = e.hasTranslation = false;
+    }
+
+    if (m_rowCacheHits + m_rowCacheMisses == 10000)
+    {
+        wxLogTrace("poedit.list", "row cache hit rate: %d%%", (int)(m_rowCacheHits / 100));
+        m_rowCacheHits = m_rowCacheMisses = 0;
+    }
+
+    return e;
+}
+
+
+void PoeditListCtrl::Model::InvalidateRowCache()
+{
+    m_rowCache.clear();
+}
+
+
+wxString PoeditListCtrl::Model::FormatSource(const CatalogItem& d) const
+{
+    wxString orig;
+    const auto orig_str = TrimTextValue(d.GetString(), m_maxVisibleWidth);
+
+#ifdef __WXMSW__
+    // Temporary workaround for https://github.com/vslavik/poedit/issues/343 and
+    // https://github.com/vslavik/poedit/issues/481 -- fall back to old style rendering:
+    if (m_appTextDir == TextDirection::RTL && m_sourceTextDir == TextDirection::LTR)
+    {
+        // non-markup rendering of source column:
+        if (d.HasContext())
+            orig.Printf("[%s] %s", d.GetContext(), orig_str);
+        else
+            orig = orig_str;
+    }
+    else
+#endif
+    {
+        if (d.HasContext())
+        {
+            // Work around a problem with GTK+'s coloring of markup that begins with colorizing <span>:
+        #ifdef __WXGTK__
+            #define MARKUP(x) L"\u200B" L##x
+        #else
+            #define MARKUP(x) x
+        #endif
+            orig.Printf(MARKUP("<span bgcolor=\"%s\" color=\"%s\"> %s | </span> %s"),
+                m_clrContextBg, m_clrContextFg,
+                EscapeMarkup(d.GetContext()), EscapeMarkup(orig_str));
+        }
+        else
+        {
+            orig = EscapeMarkup(orig_str);
+        }
+    }
+
+    // Add RTL Unicode mark to render bidi texts correctly
+    if (m_appTextDir != m_sourceTextDir)
+        return bidi::mark_direction(orig, m_sourceTextDir);
+    else
+        return orig;
+}
+
+
+wxString PoeditListCtrl::Model::FormatTranslation(const CatalogItem& d) const
+{
+    const auto trans = TrimTextValue(d.GetTranslation(), m_maxVisibleWidth);
+
+    // Add RTL Unicode mark to render bidi texts correctly
+    if (m_appTextDir != m_transTextDir)
+        return bidi::mark_direction(trans, m_transTextDir);
+    else
+        return trans;
+}
+
+
 bool PoeditListCtrl::Model::SetValueByRow(const wxVariant&, unsigned, unsigned)
 {
     wxFAIL_MSG("setting values in dataview not implemented");
@@ -499,27 +721,33 @@ void PoeditListCtrl::Model::CreateSortMap()
 
     int count = (int)m_catalog->GetCount();
 
-    m_mapListToCatalog.resize(count);
-    m_mapCatalogToList.resize(count);
+    m_sortedIndexes.resize(count);
+    m_sortRank.resize(count);
 
     // First create identity mapping for the sort order.
     for ( int i = 0; i < count; i++ )
-        m_mapListToCatalog[i] = i;
-
-    // m_mapListToCatalog will hold our desired sort order. Sort it in place
-    // now, using the desired sort criteria.
-    CatalogItemsComparator comparator(*m_catalog, sortOrder);
-    std::sort
+        m_sortedIndexes[i] = i;
+
+    // m_sortedIndexes will hold our desired sort order. Sort it in place
+    // now, using the desired sort criteria; large catalogs are sorted in parallel.
+    // Keep the comparator around for cheap updates in UpdateSortOfChangedItems().
+    wxStopWatch sw;
+    m_comparator.reset(new CatalogItemsComparator(*m_catalog, sortOrder));
+    m_changedSinceSort.assign(count, false);
+    dispatch::parallel_sort
     (
-        m_mapListToCatalog.begin(),
-        m_mapListToCatalog.end(),
-        std::ref(comparator)
+        m_sortedIndexes.begin(),
+        m_sortedIndexes.end(),
+        std::cref(*m_comparator)
     );
+    wxLogTrace("poedit", "sorted %d items in %ld ms", count, sw.Time());
 
-    // Finally, construct m_mapCatalogToList to be the inverse mapping to
-    // m_mapListToCatalog.
+    // Construct m_sortRank to be the inverse mapping to m_sortedIndexes.
     for ( int i = 0; i < count; i++ )
-        m_mapCatalogToList[m_mapListToCatalog[i]] = i;
+        m_sortRank[m_sortedIndexes[i]] = i;
+
+    // Finally, construct the mapping of (possibly filtered) rows:
+    ApplyFilter();
 }
 
 
@@ -609,6 +837,7 @@ void PoeditListCtrl::SetCustomFont(wxFont font_)
         font = GetDefaultAttributes().font;
 
     SetFont(font);
+    m_model->InvalidateRowCache();
 
 #if defined(__WXOSX__)
     // Have to propagate font setting to native columns
@@ -879,6 +1108,27 @@ void PoeditListCtrl::RefreshAllItems()
 }
 
 
+void PoeditListCtrl::RefreshCatalogItems(const std::vector<int>& catalogIndexes)
+{
+    wxDataViewItemArray items;
+    items.reserve(catalogIndexes.size());
+    for (int i: catalogIndexes)
+    {
+        m_model->MarkChanged(i);
+        auto item = CatalogIndexToListItem(i);
+        if (item.IsOk())  // may be filtered out
+            items.push_back(item);
+    }
+
+#ifdef __WXOSX__
+    // see RefreshAllItems() for why this is faster
+    RefreshAllItems();
+#else
+    m_model->ItemsChanged(items);
+#endif
+}
+
+
 void PoeditListCtrl::Sort()
 {
     if (!m_catalog)
@@ -889,6 +1139,23 @@ void PoeditListCtrl::Sort()
 }
 
 
+void PoeditListCtrl::SortChangedItems()
+{
+    if (!m_catalog)
+        return;
+
+    SelectionPreserver preserve(this);
+    m_model->UpdateSortOfChangedItems();
+}
+
+
+void PoeditListCtrl::SetFilter(Filter filter, std::vector<int> searchResults)
+{
+    SelectionPreserver preserve(m_catalog ? this : nullptr);
+    m_model->SetFilter(filter, std::move(searchResults));
+}
+
+
 void PoeditListCtrl::OnSize(wxSizeEvent& event)
 {
     wxWindowUpdateLocker lock(this);
@@ -30,6 +30,7 @@
 #include <wx/dataview.h>
 #include <wx/frame.h>
 
+#include <memory>
 #include <vector>
 
 class WXDLLIMPEXP_FWD_CORE wxListCtrl;
@@ -51,6 +52,37 @@ class PoeditListCtrl : public wxDataViewCtrl
         /// Re-sort the control according to user-specified criteria.
         void Sort();
 
+        /// Which items to show in the list
+        enum class Filter
+        {
+            All,
+            Untranslated,
+            Fuzzy,
+            Unfinished,
+            Errors,
+            Search  // only items given to SetFilter()
+        };
+
+        /**
+            Show only items matching @a filter, in current sort order.
+
+            For Filter::Search, @a searchResults are catalog indexes of items
+            to show. Other filters use catalog's CatalogItemStates; the list is
+            updated to reflect state changes by SortChangedItems().
+         */
+        void SetFilter(Filter filter, std::vector<int> searchResults = {});
+        Filter GetFilter() const { return m_model->GetFilter(); }
+
+        /**
+            Update position of items that changed since the last sort, i.e.
+            were refreshed with RefreshItem() or ForSelectedCatalogItemsDo(),
+            or whose validation status changed.
+
+            This is much faster than Sort(), which should be used when the
+            sort order or the catalog changes.
+         */
+        void SortChangedItems();
+
         void SizeColumns();
 
         void SetDisplayLines(bool dl);
@@ -136,7 +168,11 @@ class PoeditListCtrl : public wxDataViewCtrl
         {
             wxDataViewItemArray sel;
             for (auto i: selection)
-                sel.push_back(CatalogIndexToListItem(i));
+            {
+                auto item = CatalogIndexToListItem(i);
+                if (item.IsOk()) // may be filtered out
+                    sel.push_back(item);
+            }
             SetSelections(sel);
         }
 
@@ -149,7 +185,10 @@ class PoeditListCtrl : public wxDataViewCtrl
             wxDataViewItemArray sel;
             GetSelections(sel);
             for (auto item: sel)
+            {
                 func(*ListItemToCatalogItem(item));
+                m_model->MarkChanged(item);
+            }
             m_model->ItemsChanged(sel);
         }
 
@@ -201,9 +240,13 @@ class PoeditListCtrl : public wxDataViewCtrl
 
         void RefreshItem(const wxDataViewItem& item)
         {
+            m_model->MarkChanged(item);
             m_model->ItemChanged(item);
         }
 
+        /// Like RefreshItem(), but for many items given by catalog indexes at once
+        void RefreshCatalogItems(const std::vector<int>& catalogIndexes);
+
         int GetCurrentItemListIndex()
         {
             return m_model->GetRow(GetCurrentItem());
@@ -246,6 +289,24 @@ class PoeditListCtrl : public wxDataViewCtrl
             void SetCatalog(CatalogPtr catalog);
             void UpdateSort();
 
+            /// Reposition items marked with MarkChanged() or whose status changed
+            void UpdateSortOfChangedItems();
+
+            void SetFilter(Filter filter, std::vector<int> searchResults);
+            Filter GetFilter() const { return m_filter; }
+
+            /// Mark item as modified, to be repositioned by UpdateSortOfChangedItems()
+            void MarkChanged(const wxDataViewItem& item)
+            {
+                MarkChanged(CatalogIndex(GetRow(item)));
+            }
+
+            void MarkChanged(int catalogIndex)
+            {
+                if (catalogIndex >= 0 && catalogIndex < (int)m_changedSinceSort.size())
+                    m_changedSinceSort[catalogIndex] = true;
+            }
+
             unsigned int GetColumnCount() const override { return Col_Max; }
             wxString GetColumnType( unsigned int col ) const override;
 
@@ -292,11 +353,20 @@ class PoeditListCtrl : public wxDataViewCtrl
             }
 
             void CreateSortMap();
+            void ApplyFilter();
 
             void Freeze() { m_frozen = true; }
             void Thaw() { m_frozen = false; }
 
-            void SetMaxVisibleWidth(int chars) { m_maxVisibleWidth = chars; }
+            /// Forget cached formatting of rows, e.g. after visual changes
+            void InvalidateRowCache();
+
+            void SetMaxVisibleWidth(int chars)
+            {
+                if (chars != m_maxVisibleWidth)
+                    InvalidateRowCache();
+                m_maxVisibleWidth = chars;
+            }
 
         public:
             CatalogPtr m_catalog;
@@ -305,9 +375,41 @@ class PoeditListCtrl : public wxDataViewCtrl
         private:
             bool m_frozen;
             int m_maxVisibleWidth;
+            // all items in sort order and each item's position in it:
+            std::vector<int> m_sortedIndexes;
+            std::vector<int> m_sortRank;
+
+            // shown (i.e. filtered) rows; -1 for items not shown
+            Filter m_filter = Filter::All;
+            std::vector<int> m_searchResults;
             std::vector<int> m_mapListToCatalog;
             std::vector<int> m_mapCatalogToList;
 
+            // Formatted text columns are expensive to compute, but painting
+            // requests them repeatedly, e.g. when scrolling. Keep them in a
+            // small direct-mapped cache indexed by catalog index and validated
+            // by item generation.
+            struct RowCacheEntry
+            {
+                int index = -1;
+                const CatalogItem *item = nullptr;
+                unsigned generation = 0;
+                wxString source, translation;
+                bool hasSource = false, hasTranslation = false;
+            };
+            static const size_t ROW_CACHE_SIZE = 1024;
+
+            RowCacheEntry& CachedRow(int index, const CatalogItem& item) const;
+            wxString FormatSource(const CatalogItem& item) const;
+            wxString FormatTranslation(const CatalogItem& item) const;
+
+            mutable std::vector<RowCacheEntry> m_rowCache;
+            mutable unsigned m_rowCacheHits = 0, m_rowCacheMisses = 0;
+
+            // comparator used for the last sort, with cached keys
+            std::unique_ptr<CatalogItemsComparator> m_comparator;
+            std::vector<bool> m_changedSinceSort;
+
             TextDirection m_sourceTextDir, m_transTextDir, m_appTextDir;
 
             wxColour m_clrID, m_clrInvalid, m_clrFuzzy;
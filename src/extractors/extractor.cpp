@@ -27,56 +27,106 @@
 
 #include "extractor_legacy.h"
 
+#include "catalog_po.h"
+#include "concurrency.h"
+#include "errors.h"
 #include "gexecute.h"
+#include "str_helpers.h"
 
+#include <wx/datetime.h>
 #include <wx/dir.h>
+#include <wx/file.h>
 #include <wx/filename.h>
+#include <wx/log.h>
 #include <wx/textfile.h>
 
 #include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#ifndef __WXMSW__
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#endif
 
 namespace
 {
 
 // Path matching with support for wildcards
 
-struct PathToMatch
-{
-    wxString path;
-    bool isWildcard;
-
-    bool MatchesFile(const wxString& fn) const
-    {
-        if (isWildcard)
-            return wxMatchWild(path, fn);
-        else
-            return fn == path || fn.starts_with(path + "/");
-    }
-};
+/**
+    Set of paths to match files against.
 
+    Paths may be either plain paths to files or directories (matching
+    everything inside them), or wildcards. The set is preprocessed for fast
+    matching: plain paths are looked up directly for the file and each of its
+    parent directories, and wildcards are only evaluated for files that
+    start and end with their literal prefix and suffix.
+ */
 class PathsToMatch
 {
 public:
     PathsToMatch() {}
     explicit PathsToMatch(const wxArrayString& a)
     {
-        paths.reserve(a.size());
         for (auto& p: a)
-            paths.push_back({p, wxIsWild(p)});
+        {
+            if (wxIsWild(p))
+            {
+                Wildcard w;
+                w.pattern = p;
+                // wxIsWild() also considers e.g. "[" special, but wxMatchWild() only handles * and ?
+                if (p.find_first_of("*?") != wxString::npos)
+                {
+                    w.prefix = p.substr(0, p.find_first_of("*?"));
+                    w.suffix = p.substr(p.find_last_of("*?") + 1);
+                }
+                m_wildcards.push_back(w);
+            }
+            else
+            {
+                m_paths.insert(p);
+            }
+        }
     }
 
     bool MatchesFile(const wxString& fn) const
     {
-        for (auto& p: paths)
+        if (!m_paths.empty())
+        {
+            // check the file itself and all directories containing it:
+            for (size_t pos = fn.find('/'); pos != wxString::npos; pos = fn.find('/', pos + 1))
+            {
+                if (m_paths.find(fn.substr(0, pos)) != m_paths.end())
+                    return true;
+            }
+            if (m_paths.find(fn) != m_paths.end())
+                return true;
+        }
+
+        for (auto& w: m_wildcards)
         {
-            if (p.MatchesFile(fn))
+            if (fn.length() < w.prefix.length() + w.suffix.length())
+                continue;
+            if (!fn.starts_with(w.prefix) || !fn.ends_with(w.suffix))
+                continue;
+            if (wxMatchWild(w.pattern, fn))
                 return true;
         }
+
         return false;
     }
 
 private:
-    std::vector<PathToMatch> paths;
+    struct Wildcard
+    {
+        wxString pattern;
+        wxString prefix, suffix; // literal parts of the pattern
+    };
+
+    std::set<wxString> m_paths;
+    std::vector<Wildcard> m_wildcards;
 };
 
 inline void CheckReadPermissions(const wxString& basepath, const wxString& path)
@@ -93,28 +143,41 @@ inline bool IsVCSDir(const wxString& d)
 }
 
 
-int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMatch& excludedPaths,
-              Extractor::FilesList& output)
+/// Files and subdirectories found in a directory, as paths relative to the base path
+struct DirContents
 {
-    if (dirname.empty())
-        return 0;
+    Extractor::FilesList files;
+    std::vector<wxString> dirs;
+};
 
-    wxDir dir(basepath + dirname);
+/**
+    Reads content of the directory @a dirname, skipping hidden and excluded
+    entries and VCS directories.
 
+    Can be called from any thread.
+ */
+void ReadDirectory(const wxString& basepath, const wxString& dirname, const PathsToMatch& excludedPaths,
+                   DirContents& output)
+{
     CheckReadPermissions(basepath, dirname);
 
+    auto fullpathOf = [&dirname](const wxString& filename)
+    {
+        return (dirname == ".") ? filename : dirname + "/" + filename;
+    };
+
+#ifdef __WXMSW__
+    wxDir dir(basepath + dirname);
     if (!dir.IsOpened())
-        return 0;
+        return;
 
     bool cont;
     wxString iter;
-    int found = 0;
-    
+
     cont = dir.GetFirst(&iter, wxEmptyString, wxDIR_FILES);
     while (cont)
     {
-        const wxString filename = iter;
-        const wxString fullpath = (dirname == ".") ? filename : dirname + "/" + filename;
+        const wxString fullpath = fullpathOf(iter);
         cont = dir.GetNext(&iter);
 
         if (excludedPaths.MatchesFile(fullpath))
@@ -124,18 +187,16 @@ int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMa
         // not: if it is a broken symlink. FileExists() follows the symlink to check.
         if (!wxFileName::FileExists(basepath + fullpath))
             continue;
-        
+
         CheckReadPermissions(basepath, fullpath);
-        wxLogTrace("poedit.extractor", "  - %s", fullpath);
-        output.push_back(fullpath);
-        found++;
+        output.files.push_back(fullpath);
     }
 
     cont = dir.GetFirst(&iter, wxEmptyString, wxDIR_DIRS);
     while (cont)
     {
         const wxString filename = iter;
-        const wxString fullpath = (dirname == ".") ? filename : dirname + "/" + filename;
+        const wxString fullpath = fullpathOf(filename);
         cont = dir.GetNext(&iter);
 
         if (IsVCSDir(filename))
@@ -144,13 +205,855 @@ int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMa
         if (excludedPaths.MatchesFile(fullpath))
             continue;
 
-        CheckReadPermissions(basepath, fullpath);
-        found += FindInDir(basepath, fullpath, excludedPaths, output);
+        output.dirs.push_back(fullpath);
+    }
+#else // POSIX
+    // Use readdir() directly instead of wxDir: its d_type field tells us the
+    // kind of most entries, saving a stat() call for each of them.
+    DIR *dir = opendir((basepath + dirname).fn_str());
+    if (!dir)
+        return;
+
+    const int fd = dirfd(dir);
+    while (auto entry = readdir(dir))
+    {
+        // skip ".", ".." and hidden files, consistently with wxDir:
+        if (entry->d_name[0] == '.')
+            continue;
+
+        bool isDir;
+        switch (entry->d_type)
+        {
+            case DT_DIR:
+                isDir = true;
+                break;
+            case DT_REG:
+                isDir = false;
+                break;
+            case DT_LNK:
+            case DT_UNKNOWN:
+            {
+                // follow symlinks; broken ones are skipped
+                struct stat st;
+                if (fstatat(fd, entry->d_name, &st, 0) != 0)
+                    continue;
+                if (S_ISDIR(st.st_mode))
+                    isDir = true;
+                else if (S_ISREG(st.st_mode))
+                    isDir = false;
+                else
+                    continue;
+                break;
+            }
+            default:
+                continue; // pipes, sockets etc.
+        }
+
+        const wxString filename(entry->d_name, *wxConvFileName);
+        const wxString fullpath = fullpathOf(filename);
+
+        if (isDir && IsVCSDir(filename))
+            continue;
+
+        if (excludedPaths.MatchesFile(fullpath))
+            continue;
+
+        if (isDir)
+            output.dirs.push_back(fullpath);
+        else
+            output.files.push_back(fullpath);
+    }
+
+    closedir(dir);
+#endif // __WXMSW__/POSIX
+}
+
+
+int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMatch& excludedPaths,
+              Extractor::FilesList& output)
+{
+    if (dirname.empty())
+        return 0;
+
+    int found = 0;
+
+    // Traverse the tree breadth-first, reading all directories at the same
+    // depth in parallel:
+    std::vector<wxString> level{dirname};
+    while (!level.empty())
+    {
+        std::vector<DirContents> contents(level.size());
+        dispatch::parallel_for(level.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                ReadDirectory(basepath, level[i], excludedPaths, contents[i]);
+        });
+
+        std::vector<wxString> next;
+        for (auto& c: contents)
+        {
+            for (auto& f: c.files)
+                wxLogTrace("poedit.extractor", "  - %s", f);
+            found += (int)c.files.size();
+            output.insert(output.end(), c.files.begin(), c.files.end());
+            next.insert(next.end(), c.dirs.begin(), c.dirs.end());
+        }
+        level = std::move(next);
     }
 
     return found;
 }
 
+// Per-file caching of extraction results
+
+struct SourceFileInfo
+{
+    int64_t size = -1;
+    int64_t mtime = -1;
+    uint64_t hash = 0;
+};
+
+SourceFileInfo GetSourceFileInfo(const wxString& path)
+{
+    SourceFileInfo info;
+
+    wxLogNull null;
+    wxFile f;
+    if (!f.Open(path))
+        return info;
+
+    info.size = f.Length();
+    info.mtime = wxFileModificationTime(path);
+
+    str::hash64 hash;
+    char buffer[64 * 1024];
+    for (;;)
+    {
+        auto len = f.Read(buffer, sizeof(buffer));
+        if (len <= 0 || len == wxInvalidOffset)
+            break;
+        hash.add_bytes(buffer, len);
+    }
+    info.hash = hash.value();
+
+    return info;
+}
+
+
+const char POT_FRAGMENT_HEADER[] =
+    "msgid \"\"\n"
+    "msgstr \"\"\n"
+    "\"Content-Type: text/plain; charset=UTF-8\\n\"\n"
+    "\"Content-Transfer-Encoding: 8bit\\n\"\n";
+
+bool WritePOTFragment(const wxString& filename, const std::string& entries)
+{
+    std::string content(POT_FRAGMENT_HEADER);
+    if (!entries.empty())
+    {
+        content += '\n';
+        content += entries;
+    }
+
+    wxLogNull null;
+    wxTempFile f(filename);
+    return f.IsOpened() && f.Write(content.data(), content.size()) && f.Commit();
+}
+
+
+/**
+    Splits POT file produced by an extractor into per-file parts.
+
+    Each entry is appended to the parts of all files it references, with
+    references limited to the respective file. @a parts must contain
+    entries for all files processed by the extractor, keyed by UTF-8 path.
+
+    Note that such parts are only independent of each other if the POT was
+    produced from a single file, because xgettext merges comments, flags
+    etc. of all occurrences of a string into one entry.
+
+    Returns false if the file can't be split, e.g. because it doesn't
+    contain references or isn't UTF-8.
+ */
+bool SplitPOTByFile(const wxString& pot_file, std::map<std::string, std::string>& parts)
+{
+    // Unicode isolates used by gettext around filenames with spaces:
+    static const std::string_view FSI("\xE2\x81\xA8"), PDI("\xE2\x81\xA9");
+
+    std::string data;
+    {
+        wxLogNull null;
+        wxFile f;
+        if (!f.Open(pot_file))
+            return false;
+        data.resize(f.Length());
+        if (f.Read(data.data(), data.size()) != (ssize_t)data.size())
+            return false;
+    }
+
+    const std::string_view all(data);
+    bool first = true;
+    size_t pos = 0;
+    while (pos < all.size())
+    {
+        // entries are separated by empty lines:
+        auto end = all.find("\n\n", pos);
+        if (end == std::string_view::npos)
+            end = all.size();
+        auto entry = all.substr(pos, end - pos);
+        pos = end + 1;
+
+        while (!entry.empty() && entry.front() == '\n')
+            entry.remove_prefix(1);
+        if (entry.empty())
+            continue;
+
+        if (first)
+        {
+            first = false;
+            if (entry.find("msgid \"\"\nmsgstr \"\"\n") != std::string_view::npos &&
+                entry.find("msgctxt ") == std::string_view::npos)
+            {
+                auto charset = entry.find("charset=");
+                if (charset == std::string_view::npos)
+                    return false;
+                charset += 8;
+                if (entry.substr(charset, 5) != "UTF-8" && entry.substr(charset, 7) != "CHARSET")
+                    return false;
+                continue;
+            }
+        }
+
+        std::vector<std::string_view> lines;
+        std::vector<std::pair<std::string_view, std::string_view>> refs; // (file, reference)
+        size_t lineStart = 0;
+        while (lineStart < entry.size())
+        {
+            auto lineEnd = entry.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+                lineEnd = entry.size();
+            auto line = entry.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            lines.push_back(line);
+
+            if (line.substr(0, 2) != "#:")
+                continue;
+
+            size_t i = 2;
+            while (i < line.size())
+            {
+                if (line[i] == ' ')
+                {
+                    i++;
+                    continue;
+                }
+
+                const size_t refStart = i;
+                std::string_view file;
+                if (line.substr(i, FSI.size()) == FSI)
+                {
+                    auto close = line.find(PDI, i);
+                    if (close == std::string_view::npos)
+                        return false;
+                    file = line.substr(i + FSI.size(), close - i - FSI.size());
+                    i = close + PDI.size();
+                }
+                while (i < line.size() && line[i] != ' ')
+                    i++;
+
+                auto ref = line.substr(refStart, i - refStart);
+                if (file.empty())
+                {
+                    file = ref;
+                    auto colon = ref.rfind(':');
+                    if (colon != std::string_view::npos && colon + 1 < ref.size() &&
+                        ref.find_first_not_of("0123456789", colon + 1) == std::string_view::npos)
+                    {
+                        file = ref.substr(0, colon);
+                    }
+                }
+                refs.emplace_back(file, ref);
+            }
+        }
+
+        if (refs.empty())
+            return false;
+
+        // emit the entry for every referenced file, in order of their first appearance:
+        for (size_t r = 0; r < refs.size(); r++)
+        {
+            const auto file = refs[r].first;
+            bool seen = false;
+            for (size_t prev = 0; prev < r && !seen; prev++)
+                seen = refs[prev].first == file;
+            if (seen)
+                continue;
+
+            auto part = parts.find(std::string(file));
+            if (part == parts.end())
+                return false;
+
+            auto& out = part->second;
+            if (!out.empty())
+                out += '\n';
+
+            bool refsWritten = false;
+            for (auto& line: lines)
+            {
+                if (line.substr(0, 2) == "#:")
+                {
+                    if (refsWritten)
+                        continue;
+                    out += "#:";
+                    for (size_t i = r; i < refs.size(); i++)
+                    {
+                        if (refs[i].first != file)
+                            continue;
+                        out += ' ';
+                        out += refs[i].second;
+                    }
+                    out += '\n';
+                    refsWritten = true;
+                }
+                else
+                {
+                    out += line;
+                    out += '\n';
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Persistent cache of per-file extraction results.
+
+    Strings extracted from each source file are kept in a small POT file,
+    indexed by the file's path, size, modification time and content hash,
+    together with issues reported for it. Every extractor configuration (see
+    Extractor::GetCacheSignature()) has its own cache, so that e.g. changing
+    keywords invalidates it.
+ */
+class ExtractionCache
+{
+public:
+    struct Entry
+    {
+        SourceFileInfo info;
+        wxString pot_file;
+        std::vector<ParsedGettextErrors::Item> issues;
+        bool used = false;
+    };
+
+    ExtractionCache(const wxString& cacheDir, const wxString& signature) : m_dirty(false)
+    {
+        m_dir = cacheDir + wxFILE_SEP_PATH + wxString::Format("%016llx", (unsigned long long)str::hash64().add(signature).value());
+        Load();
+    }
+
+    /// Returns cached results for @a file if they are still valid, nullptr otherwise.
+    const Entry *Lookup(const wxString& file, const SourceFileInfo& info)
+    {
+        auto i = m_entries.find(file);
+        if (i == m_entries.end())
+            return nullptr;
+
+        auto& e = i->second;
+        if (info.size < 0 || e.info.size != info.size || e.info.mtime != info.mtime || e.info.hash != info.hash)
+            return nullptr;
+
+        e.used = true;
+        return &e;
+    }
+
+    /// Stores extraction results for @a file; @a entries are the POT entries extracted from it.
+    const Entry& Store(const wxString& file, const SourceFileInfo& info,
+                       const std::string& entries, std::vector<ParsedGettextErrors::Item>&& issues)
+    {
+        auto& e = m_entries[file];
+        RemoveFile(e);
+
+        e.info = info;
+        e.issues = std::move(issues);
+        e.used = true;
+        e.pot_file.clear();
+        m_dirty = true;
+
+        if (!entries.empty())
+        {
+            e.pot_file = m_dir + wxFILE_SEP_PATH + wxString::Format("%016llx.pot", (unsigned long long)str::hash64().add(file).add(info.hash).value());
+            if (!WritePOTFragment(e.pot_file, entries))
+            {
+                e.pot_file.clear();
+                e.info = SourceFileInfo();  // invalid, will be re-extracted next time
+            }
+        }
+
+        return e;
+    }
+
+    /// Writes the cache to disk, dropping entries for files that weren't used.
+    void Save()
+    {
+        for (auto i = m_entries.begin(); i != m_entries.end(); )
+        {
+            if (i->second.used)
+            {
+                ++i;
+            }
+            else
+            {
+                RemoveFile(i->second);
+                i = m_entries.erase(i);
+                m_dirty = true;
+            }
+        }
+
+        if (!m_dirty)
+            return;
+
+        std::string buf(MAGIC, sizeof(MAGIC));
+        Put(buf, (uint32_t)m_entries.size());
+        for (auto& i: m_entries)
+        {
+            auto& e = i.second;
+            PutString(buf, i.first);
+            Put(buf, e.info.size);
+            Put(buf, e.info.mtime);
+            Put(buf, e.info.hash);
+            PutString(buf, wxFileName(e.pot_file).GetFullName());
+            Put(buf, (uint32_t)e.issues.size());
+            for (auto& issue: e.issues)
+            {
+                Put(buf, (int32_t)issue.level);
+                Put(buf, (int32_t)issue.line);
+                PutString(buf, issue.text);
+            }
+        }
+
+        wxLogNull null;
+        wxTempFile f(GetIndexFileName());
+        if (f.IsOpened() && f.Write(buf.data(), buf.size()) && f.Commit())
+            m_dirty = false;
+    }
+
+private:
+    // identifies file format, including version:
+    static constexpr char MAGIC[8] = {'P','o','e','d','E','x','t','1'};
+
+    wxString GetIndexFileName() const { return m_dir + wxFILE_SEP_PATH + "index.bin"; }
+
+    void RemoveFile(const Entry& e)
+    {
+        if (!e.pot_file.empty() && wxFileExists(e.pot_file))
+            wxRemoveFile(e.pot_file);
+    }
+
+    void Load()
+    {
+        wxLogNull null;
+
+        if (!wxFileName::DirExists(m_dir))
+        {
+            wxFileName::Mkdir(m_dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+            return;
+        }
+
+        wxFile f;
+        if (!wxFile::Exists(GetIndexFileName()) || !f.Open(GetIndexFileName()))
+            return;
+
+        std::string buf(f.Length(), '\0');
+        if (f.Read(&buf[0], buf.size()) != (ssize_t)buf.size())
+            return;
+        if (buf.size() < sizeof(MAGIC) || memcmp(buf.data(), MAGIC, sizeof(MAGIC)) != 0)
+            return;
+
+        Reader r{buf.data() + sizeof(MAGIC), buf.data() + buf.size()};
+        auto count = r.Get<uint32_t>();
+        for (uint32_t i = 0; i < count && r.ok; i++)
+        {
+            auto file = r.GetString();
+            Entry e;
+            e.info.size = r.Get<int64_t>();
+            e.info.mtime = r.Get<int64_t>();
+            e.info.hash = r.Get<uint64_t>();
+            auto potName = r.GetString();
+            if (!potName.empty())
+                e.pot_file = m_dir + wxFILE_SEP_PATH + potName;
+            auto issues = r.Get<uint32_t>();
+            for (uint32_t n = 0; n < issues && r.ok; n++)
+            {
+                ParsedGettextErrors::Item issue;
+                issue.level = (ParsedGettextErrors::Level)r.Get<int32_t>();
+                issue.line = r.Get<int32_t>();
+                issue.text = r.GetString();
+                issue.file = file;
+                e.issues.push_back(issue);
+            }
+            if (r.ok && (e.pot_file.empty() || wxFileExists(e.pot_file)))
+                m_entries[file] = std::move(e);
+        }
+    }
+
+    template<typename T>
+    static void Put(std::string& buf, T value)
+    {
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void PutString(std::string& buf, const wxString& s)
+    {
+        auto utf8 = str::to_utf8(s);
+        Put(buf, (uint32_t)utf8.size());
+        buf += utf8;
+    }
+
+    struct Reader
+    {
+        const char *p, *end;
+        bool ok = true;
+
+        template<typename T>
+        T Get()
+        {
+            T value = T();
+            if (!ok || size_t(end - p) < sizeof(T))
+            {
+                ok = false;
+                return value;
+            }
+            memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return value;
+        }
+
+        wxString GetString()
+        {
+            auto len = Get<uint32_t>();
+            if (!ok || size_t(end - p) < len)
+            {
+                ok = false;
+                return wxString();
+            }
+            wxString s = str::to_wx(std::string(p, len));
+            p += len;
+            return s;
+        }
+    };
+
+    wxString m_dir;
+    std::map<wxString, Entry> m_entries;
+    bool m_dirty;
+};
+
+
+/// Extracts strings from @a files using @a ex, reusing cached results for unchanged files.
+void ExtractUsingCache(TempDirectory& tmpdir,
+                       const SourceCodeSpec& sourceSpec,
+                       const Extractor& ex,
+                       const Extractor::FilesList& files,
+                       ExtractionCache& cache,
+                       std::vector<ExtractionOutput>& partials)
+{
+    std::vector<SourceFileInfo> infos(files.size());
+    dispatch::parallel_for(files.size(), 16, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            infos[i] = GetSourceFileInfo(sourceSpec.BasePath + files[i]);
+    });
+
+    std::vector<const ExtractionCache::Entry*> entries(files.size());
+    Extractor::FilesList changed;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        entries[i] = cache.Lookup(files[i], infos[i]);
+        if (!entries[i])
+            changed.push_back(files[i]);
+    }
+
+    wxLogTrace("poedit.extractor", "    %d files cached, %d changed", int(files.size() - changed.size()), (int)changed.size());
+
+    ParsedGettextErrors errors;
+    std::map<size_t, wxString> fallbackFiles;
+
+    if (!changed.empty())
+    {
+        // Every file is extracted on its own, so that its cached part doesn't
+        // include e.g. comments or flags from other files' occurrences of the
+        // same string, which could be outdated later:
+        auto subs = ex.ExtractEachFile(tmpdir, sourceSpec, changed);
+
+        std::map<std::string, std::string> parts;
+        for (auto& f: changed)
+            parts[str::to_utf8(f)];
+
+        bool splittable = true;
+        for (auto& sub: subs)
+        {
+            if (!sub || sub.pot_file.empty() || !SplitPOTByFile(sub.pot_file, parts))
+            {
+                splittable = false;
+                break;
+            }
+        }
+
+        if (!splittable)
+        {
+            wxLogTrace("poedit.extractor", "    can't split output per file, not caching");
+            if (changed.size() < files.size())
+                subs = ex.ExtractInParts(tmpdir, sourceSpec, files);
+            for (auto& sub: subs)
+            {
+                if (sub)
+                    partials.push_back(sub);
+            }
+            return;
+        }
+
+        // distribute reported issues to files:
+        std::map<wxString, std::vector<ParsedGettextErrors::Item>> issues;
+        for (auto& sub: subs)
+        {
+            for (auto& i: sub.errors.items)
+            {
+                if (i.has_location() && parts.find(str::to_utf8(i.file)) != parts.end())
+                    issues[i.file].push_back(i);
+                else
+                    errors.items.push_back(i);
+            }
+        }
+
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (entries[i])
+                continue;
+            auto& content = parts[str::to_utf8(files[i])];
+            entries[i] = &cache.Store(files[i], infos[i], content, std::move(issues[files[i]]));
+            if (!content.empty() && entries[i]->pot_file.empty())
+            {
+                // couldn't write into the cache, use an uncached file for this time
+                auto fallback = tmpdir.CreateFileName("part.pot");
+                WritePOTFragment(fallback, content);
+                fallbackFiles[i] = fallback;
+            }
+        }
+
+        cache.Save();
+
+        if (changed.size() == files.size())
+        {
+            // nothing was cached, so the per-file outputs can be used as they are
+            partials.insert(partials.end(), subs.begin(), subs.end());
+            return;
+        }
+    }
+    else
+    {
+        cache.Save();
+    }
+
+    // Concatenate per-file results in the order of files; this produces the
+    // same output as extracting all files at once would:
+    const size_t firstPartial = partials.size();
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        auto e = entries[i];
+        errors.items.insert(errors.items.end(), e->issues.begin(), e->issues.end());
+        if (!e->pot_file.empty())
+            partials.push_back({e->pot_file, {}});
+        else if (fallbackFiles.count(i))
+            partials.push_back({fallbackFiles[i], {}});
+    }
+
+    if (partials.size() == firstPartial)
+    {
+        // no strings in any of the files, but they were still processed:
+        auto empty = tmpdir.CreateFileName("empty.pot");
+        WritePOTFragment(empty, std::string());
+        partials.push_back({empty, {}});
+    }
+
+    partials[firstPartial].errors = errors;
+}
+
+
+// Last modification time of source files, for POT-Creation-Date
+
+/// Runs git with given arguments in @a dir, returns its output or empty string on failure.
+std::string RunGit(const wxString& dir, const std::vector<wxString>& args)
+{
+    try
+    {
+        std::vector<wxString> argv {"git", "--literal-pathspecs"};
+        argv.insert(argv.end(), args.begin(), args.end());
+
+        subprocess::Runner runner;
+        runner.set_cwd(dir);
+        auto output = runner.run_sync(argv);
+        if (output.failed())
+            return std::string();
+        return output.std_out;
+    }
+    catch (...)
+    {
+        return std::string();
+    }
+}
+
+/// Splits NUL-separated git output (-z) into paths.
+std::set<wxString> SplitGitPaths(const std::string& output)
+{
+    std::set<wxString> paths;
+    size_t start = 0;
+    while (start < output.size())
+    {
+        auto end = output.find('\0', start);
+        if (end == std::string::npos)
+            end = output.size();
+        if (end > start)
+            paths.insert(str::to_wx(output.substr(start, end - start)));
+        start = end + 1;
+    }
+    return paths;
+}
+
+
+/**
+    Cache of last commit times for sets of files.
+
+    Entries are keyed by a hash of HEAD commit and the files, so they never
+    become invalid, only unused; a small number of most recent ones is kept.
+ */
+class CommitTimesCache
+{
+public:
+    explicit CommitTimesCache(const wxString& cacheDir)
+    {
+        if (!cacheDir.empty())
+            m_filename = cacheDir + wxFILE_SEP_PATH + "commit_times.bin";
+        Load();
+    }
+
+    bool Lookup(uint64_t key, int64_t& time) const
+    {
+        for (auto& r: m_records)
+        {
+            if (r.key == key)
+            {
+                time = r.time;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Store(uint64_t key, int64_t time)
+    {
+        m_records.erase(std::remove_if(m_records.begin(), m_records.end(), [=](const Record& r){ return r.key == key; }),
+                        m_records.end());
+        m_records.insert(m_records.begin(), Record{key, time});
+        if (m_records.size() > MAX_RECORDS)
+            m_records.resize(MAX_RECORDS);
+        Save();
+    }
+
+private:
+    struct Record
+    {
+        uint64_t key;
+        int64_t time;
+    };
+
+    static const size_t MAX_RECORDS = 64;
+    // identifies file format, including version:
+    static constexpr char MAGIC[8] = {'P','o','e','d','G','i','t','1'};
+
+    void Load()
+    {
+        wxLogNull null;
+        wxFile f;
+        if (m_filename.empty() || !wxFile::Exists(m_filename) || !f.Open(m_filename))
+            return;
+
+        std::string buf(f.Length(), '\0');
+        if (f.Read(&buf[0], buf.size()) != (ssize_t)buf.size())
+            return;
+        if (buf.size() < sizeof(MAGIC) || memcmp(buf.data(), MAGIC, sizeof(MAGIC)) != 0)
+            return;
+
+        const size_t count = std::min((buf.size() - sizeof(MAGIC)) / sizeof(Record), MAX_RECORDS);
+        m_records.resize(count);
+        memcpy(m_records.data(), buf.data() + sizeof(MAGIC), count * sizeof(Record));
+    }
+
+    void Save()
+    {
+        if (m_filename.empty())
+            return;
+
+        std::string buf(MAGIC, sizeof(MAGIC));
+        buf.append(reinterpret_cast<const char*>(m_records.data()), m_records.size() * sizeof(Record));
+
+        wxLogNull null;
+        if (!wxFileName::DirExists(wxPathOnly(m_filename)))
+            wxFileName::Mkdir(wxPathOnly(m_filename), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        wxTempFile f(m_filename);
+        if (f.IsOpened() && f.Write(buf.data(), buf.size()))
+            f.Commit();
+    }
+
+    wxString m_filename;
+    std::vector<Record> m_records;
+};
+
+
+/**
+    Returns time of the most recent commit that touched any of @a files
+    (paths relative to @a dir), or -1 if it cannot be determined.
+
+    git-log is run in parallel on batches of files, which is much faster than
+    running it once for every file as xgettext does.
+ */
+int64_t GetLastCommitTime(const wxString& dir, const std::vector<wxString>& files)
+{
+    // keep command lines well below the limit on Windows:
+    const size_t MAX_BATCH_LENGTH = 16000;
+
+    std::vector<std::vector<wxString>> batches;
+    size_t length = MAX_BATCH_LENGTH;
+    for (auto& f: files)
+    {
+        if (length + f.length() > MAX_BATCH_LENGTH)
+        {
+            batches.push_back({"log", "-1", "--format=%ct", "HEAD", "--"});
+            length = 0;
+        }
+        batches.back().push_back(f);
+        length += f.length() + 3;
+    }
+
+    std::vector<int64_t> times(batches.size(), -1);
+    dispatch::parallel_for(batches.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            long long t;
+            auto out = str::to_wx(RunGit(dir, batches[i]));
+            if (out.Trim().ToLongLong(&t))
+                times[i] = t;
+        }
+    });
+
+    if (std::find(times.begin(), times.end(), -1) != times.end())
+        return -1;
+    return times.empty() ? -1 : *std::max_element(times.begin(), times.end());
+}
+
+
 } // anonymous namespace
 
 
@@ -195,7 +1098,7 @@ Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources)
     // traversal has, generally speaking, undefined order, and the order differs
     // between filesystems. Finally, the order is reflected in the created PO
     // files and it is much better for diffs if it remains consistent.
-    std::sort(output.begin(), output.end());
+    dispatch::parallel_sort(output.begin(), output.end(), std::less<wxString>());
 
     wxLogTrace("poedit.extractor", "finished collecting %d files", (int)output.size());
 
@@ -205,7 +1108,8 @@ Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources)
 
 ExtractionOutput Extractor::ExtractWithAll(TempDirectory& tmpdir,
                                            const SourceCodeSpec& sourceSpec,
-                                           const std::vector<wxString>& files_)
+                                           const std::vector<wxString>& files_,
+                                           const wxString& cacheDir)
 {
     auto files = files_;
     wxLogTrace("poedit.extractor", "extracting from %d files", (int)files.size());
@@ -219,9 +1123,20 @@ ExtractionOutput Extractor::ExtractWithAll(TempDirectory& tmpdir,
             continue;
 
         wxLogTrace("poedit.extractor", " .. using extractor '%s' for %d files", ex->GetId(), (int)ex_files.size());
-        auto sub = ex->Extract(tmpdir, sourceSpec, ex_files);
-        if (sub)
-            partials.push_back(sub);
+        auto signature = cacheDir.empty() ? wxString() : ex->GetCacheSignature(sourceSpec);
+        if (!signature.empty())
+        {
+            ExtractionCache cache(cacheDir, signature);
+            ExtractUsingCache(tmpdir, sourceSpec, *ex, ex_files, cache, partials);
+        }
+        else
+        {
+            for (auto& sub: ex->ExtractInParts(tmpdir, sourceSpec, ex_files))
+            {
+                if (sub)
+                    partials.push_back(sub);
+            }
+        }
 
         if (files.size() > ex_files.size())
         {
@@ -253,11 +1168,87 @@ ExtractionOutput Extractor::ExtractWithAll(TempDirectory& tmpdir,
     else
     {
         wxLogTrace("poedit.extractor", "merging %d subPOTs", (int)partials.size());
-        return ConcatPartials(tmpdir, partials);
+        return ConcatPartials(partials);
     }
 }
 
 
+wxString Extractor::GetSourcesModificationDate(const SourceCodeSpec& sourceSpec,
+                                               const std::vector<wxString>& files,
+                                               const wxString& cacheDir)
+{
+    const auto& basepath = sourceSpec.BasePath;
+
+    // Files committed to git without local changes use commit time. Note that
+    // git only reports files under basepath, so anything outside of it (e.g.
+    // "../foo") is conservatively treated as modified.
+    std::vector<char> committed(files.size(), false);
+    std::vector<wxString> committedFiles;
+    const wxString head = str::to_wx(RunGit(basepath, {"rev-parse", "HEAD"})).Trim();
+    if (!head.empty())
+    {
+        auto tracked = SplitGitPaths(RunGit(basepath, {"ls-files", "-z"}));
+        auto changed = SplitGitPaths(RunGit(basepath, {"diff", "--name-only", "--relative", "-z", "HEAD"}));
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            wxString f(files[i]);
+#ifdef __WXMSW__
+            f.Replace("\\", "/");
+#endif
+            if (tracked.count(f) && !changed.count(f))
+            {
+                committed[i] = true;
+                committedFiles.push_back(f);
+            }
+        }
+    }
+
+    int64_t lastChange = -1;
+
+    if (!committedFiles.empty())
+    {
+        str::hash64 key;
+        key.add(head);
+        for (auto& f: committedFiles)
+            key.add(f);
+
+        CommitTimesCache cache(cacheDir);
+        int64_t commitTime;
+        if (cache.Lookup(key.value(), commitTime))
+        {
+            wxLogTrace("poedit.extractor", "using cached commit time for %d files", (int)committedFiles.size());
+        }
+        else
+        {
+            commitTime = GetLastCommitTime(basepath, committedFiles);
+            if (commitTime >= 0)
+                cache.Store(key.value(), commitTime);
+            else
+                committed.assign(files.size(), false);  // fall back to mtimes
+        }
+        lastChange = commitTime;
+    }
+
+    std::vector<int64_t> mtimes(files.size(), -1);
+    dispatch::parallel_for(files.size(), 64, [&](size_t begin, size_t end)
+    {
+        wxLogNull null;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!committed[i])
+                mtimes[i] = wxFileModificationTime(basepath + files[i]);
+        }
+    });
+    if (!mtimes.empty())
+        lastChange = std::max(lastChange, *std::max_element(mtimes.begin(), mtimes.end()));
+
+    if (lastChange < 0)
+        return wxString();
+
+    return wxDateTime((time_t)lastChange).Format("%Y-%m-%d %H:%M%z");
+}
+
+
 Extractor::FilesList Extractor::FilterFiles(const FilesList& files) const
 {
     FilesList out;
@@ -319,7 +1310,7 @@ void Extractor::RegisterWildcard(const wxString& wildcard)
 }
 
 
-ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vector<ExtractionOutput>& partials)
+ExtractionOutput Extractor::ConcatPartials(const std::vector<ExtractionOutput>& partials)
 {
     if (partials.empty())
     {
@@ -331,38 +1322,29 @@ ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vec
     }
 
     ExtractionOutput result;
-    result.pot_file = tmpdir.CreateFileName("concatenated.pot");
-
-    wxTextFile filelist;
-    filelist.Create(tmpdir.CreateFileName("gettext_filelist.txt"));
     for (auto& p: partials)
+        result.errors += p.errors;
+
+    try
     {
-        auto fn = p.pot_file;
-#ifdef __WXMSW__
-        // Gettext tools can't handle Unicode filenames well (due to using
-        // char* arguments), so work around this by using the short names.
-        if (!fn.IsAscii())
+        std::vector<POCatalogPtr> parts(partials.size());
+        dispatch::parallel_for(partials.size(), 1, [&](size_t begin, size_t end)
         {
-            fn = CliSafeFileName(fn);
-            fn.Replace("\\", "/");
-        }
-#endif
-        filelist.AddLine(fn);
-        result.errors += p.errors;
-    }
-    filelist.Write(wxTextFileType_Unix, wxConvFile);
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& p = partials[i];
+                if (p.catalog)
+                    parts[i] = p.catalog;
+                else
+                    parts[i] = POCatalog::Create(p.pot_file, Catalog::CreationFlag_IgnoreHeader | Catalog::CreationFlag_Partial);
+            }
+        });
 
-    GettextRunner gt;
-    auto output = gt.run_sync("msgcat",
-                              "--force-po",
-                              // avoid corrupted content of duplicate "" headers
-                              // FIXME: merge headers intelligently, e.g. pick latest POT-Creation-Date
-                              "--use-first",
-                              "-o", result.pot_file,
-                              "--files-from", filelist.GetName());
-    if (output.failed())
+        result.catalog = POCatalog::CreateByConcatenating(parts);
+    }
+    catch (...)
     {
-        wxLogError("msgcat: %s", output.std_err);
+        wxLogError("%s", DescribeCurrentException());
         wxLogError(_("Failed to merge gettext catalogs."));
         BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
     }
@@ -37,6 +37,8 @@
 #include "gexecute.h"
 #include "utility.h"
 
+class POCatalog;
+
 
 /// Specification of the source code to search.
 struct SourceCodeSpec
@@ -81,7 +83,10 @@ struct ExtractionOutput
     /// Errors/warnings that occurred during extraction.
     ParsedGettextErrors errors;
 
-    explicit operator bool() const { return !pot_file.empty(); }
+    /// Extracted strings if they were already loaded, in which case pot_file is empty.
+    std::shared_ptr<POCatalog> catalog;
+
+    explicit operator bool() const { return !pot_file.empty() || catalog; }
 };
 
 
@@ -120,10 +125,27 @@ public:
     /**
         Extracts translations from given source files using all
         available extractors.
+
+        If @a cacheDir is given, results are cached there per file and
+        only files that changed since the last extraction are processed
+        by extractors that support it (see GetCacheSignature()).
      */
     static ExtractionOutput ExtractWithAll(TempDirectory& tmpdir,
                                            const SourceCodeSpec& sourceSpec,
-                                           const std::vector<wxString>& files);
+                                           const std::vector<wxString>& files,
+                                           const wxString& cacheDir = wxString());
+
+    /**
+        Returns time of the last change to any of @a files, formatted for
+        use in the POT-Creation-Date header, or empty string if unknown.
+
+        Like xgettext, uses time of the last commit for files committed to
+        git without local modifications and modification time otherwise.
+        If @a cacheDir is given, commit times are cached there per HEAD.
+     */
+    static wxString GetSourcesModificationDate(const SourceCodeSpec& sourceSpec,
+                                               const std::vector<wxString>& files,
+                                               const wxString& cacheDir = wxString());
 
     // Extractor helpers:
 
@@ -164,6 +186,17 @@ public:
     void RegisterExtension(const wxString& ext);
     void RegisterWildcard(const wxString& wildcard);
 
+    /**
+        Returns string that uniquely identifies all settings affecting
+        extractor's output, e.g. its version, keywords or flags.
+
+        Results of extractors that return non-empty signature are cached per
+        file, using ExtractEachFile(). This requires that the output is UTF-8
+        encoded with references to all files. Default implementation returns
+        empty string, i.e. disables caching.
+     */
+    virtual wxString GetCacheSignature(const SourceCodeSpec& /*sourceSpec*/) const { return wxString(); }
+
     /**
         Extracts translations from given source files using all
         available extractors.
@@ -172,6 +205,38 @@ public:
                                      const SourceCodeSpec& sourceSpec,
                                      const std::vector<wxString>& files) const = 0;
 
+    /**
+        Like Extract(), but may return the output split into several POT
+        files, each for a contiguous range of @a files. Concatenating them in
+        order produces the same output as Extract().
+
+        Default implementation returns the output of Extract().
+     */
+    virtual std::vector<ExtractionOutput> ExtractInParts(TempDirectory& tmpdir,
+                                                         const SourceCodeSpec& sourceSpec,
+                                                         const std::vector<wxString>& files) const
+    {
+        return {Extract(tmpdir, sourceSpec, files)};
+    }
+
+    /**
+        Like ExtractInParts(), but processes every file independently of
+        others and returns one output for each of @a files, in their order.
+
+        Used for caching, where results for a file must not depend on other
+        files. Default implementation calls Extract() for each file.
+     */
+    virtual std::vector<ExtractionOutput> ExtractEachFile(TempDirectory& tmpdir,
+                                                          const SourceCodeSpec& sourceSpec,
+                                                          const std::vector<wxString>& files) const
+    {
+        std::vector<ExtractionOutput> outputs;
+        outputs.reserve(files.size());
+        for (auto& f: files)
+            outputs.push_back(Extract(tmpdir, sourceSpec, {f}));
+        return outputs;
+    }
+
 protected:
     Extractor() : m_priority(Priority::Default) {}
     virtual ~Extractor() {}
@@ -179,8 +244,8 @@ protected:
     /// Check if file is supported based on its extension
     bool HasKnownExtension(const wxString& file) const;
 
-    /// Concatenates partial outputs using msgcat
-    static ExtractionOutput ConcatPartials(TempDirectory& tmpdir, const std::vector<ExtractionOutput>& partials);
+    /// Concatenates partial outputs (in memory, equivalently to msgcat)
+    static ExtractionOutput ConcatPartials(const std::vector<ExtractionOutput>& partials);
 
 private:
     Priority m_priority;
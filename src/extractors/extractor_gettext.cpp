@@ -25,10 +25,16 @@
 
 #include "extractor.h"
 
+#include "configuration.h"
 #include "gexecute.h"
+#include "version.h"
 
+#include <wx/filename.h>
 #include <wx/textfile.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace
 {
 
@@ -101,14 +107,154 @@ public:
                              const SourceCodeSpec& sourceSpec,
                              const std::vector<wxString>& files) const override
     {
-        using subprocess::quote_arg;
+        // Partial POTs are concatenated in the order of (sorted) input files,
+        // so the output is the same regardless of how many shards were used:
+        return ConcatPartials(ExtractInParts(tmpdir, sourceSpec, files));
+    }
+
+    std::vector<ExtractionOutput> ExtractInParts(TempDirectory& tmpdir,
+                                                 const SourceCodeSpec& sourceSpec,
+                                                 const std::vector<wxString>& files) const override
+    {
+        // xgettext is single-threaded, so large inputs are split into several
+        // shards processed by concurrently running xgettext instances:
+        auto shards = SplitIntoShards(sourceSpec, files);
+        wxLogTrace("poedit.extractor", "   running xgettext in %d shard(s)", (int)shards.size());
+        return RunXgettext(tmpdir, sourceSpec, shards);
+    }
+
+    std::vector<ExtractionOutput> ExtractEachFile(TempDirectory& tmpdir,
+                                                  const SourceCodeSpec& sourceSpec,
+                                                  const std::vector<wxString>& files) const override
+    {
+        std::vector<FilesList> shards;
+        shards.reserve(files.size());
+        for (auto& f: files)
+            shards.push_back({f});
+        wxLogTrace("poedit.extractor", "   running xgettext for %d file(s) separately", (int)shards.size());
+        return RunXgettext(tmpdir, sourceSpec, shards);
+    }
 
+    wxString GetCacheSignature(const SourceCodeSpec& sourceSpec) const override
+    {
+        // Everything that affects the output is on xgettext's command line, except
+        // for the version of xgettext itself. That is not implied by Poedit's version
+        // when system gettext is used, so ask the actual binary (once, it doesn't
+        // change while running):
+        static const std::string s_xgettextVersion = []
+        {
+            auto output = GettextRunner().run_sync("xgettext", "--version");
+            return output ? output.std_out : std::string();
+        }();
+        if (s_xgettextVersion.empty())
+            return wxString();  // can't tell if cached results are valid, don't cache
+
+        return wxString::Format("%s\n%s\n%s\n%s",
+                                POEDIT_VERSION,
+                                str::to_wx(s_xgettextVersion),
+                                GetId(),
+                                BuildCommandLine(sourceSpec, sourceSpec.BasePath, "FILES", "OUTPUT"));
+    }
+    
+protected:
+    /// Don't split work into shards smaller than this
+    static const size_t MIN_FILES_PER_SHARD = 100;
+
+    /// Returns the number of xgettext instances to run concurrently
+    static size_t GetJobsCount()
+    {
+        size_t count = Config::ExtractionJobs();
+        if (count == 0)
+            count = std::max(1u, std::thread::hardware_concurrency());
+        return count;
+    }
+
+    /**
+        Runs xgettext on every list of files in @a shards, at most
+        GetJobsCount() of them at a time, and returns their outputs.
+     */
+    std::vector<ExtractionOutput> RunXgettext(TempDirectory& tmpdir,
+                                              const SourceCodeSpec& sourceSpec,
+                                              const std::vector<FilesList>& shards) const
+    {
         auto basepath = sourceSpec.BasePath;
 #ifdef __WXMSW__
         basepath = CliSafeFileName(basepath);
         basepath.Replace("\\", "/");
 #endif
 
+        const size_t jobs = GetJobsCount();
+        std::vector<GettextRunner> runners(shards.size());
+        std::vector<dispatch::future<subprocess::Output>> outputs(shards.size());
+        std::vector<ExtractionOutput> partials(shards.size());
+        bool failed = false;
+
+        auto collect = [&](size_t i)
+        {
+            auto output = outputs[i].get();
+            partials[i].errors = runners[i].parse_stderr(output);
+            if (output.failed())
+            {
+                // Total failure - don't log warnings, focus on the hard errors
+                partials[i].errors.log_errors();
+                failed = true;
+            }
+        };
+
+        for (size_t i = 0; i < shards.size(); i++)
+        {
+            if (i >= jobs)
+                collect(i - jobs);
+            auto filelist = WriteFilesList(tmpdir, shards[i]);
+            partials[i].pot_file = tmpdir.CreateFileName("gettext.pot");
+            outputs[i] = runners[i].run_command_async(BuildCommandLine(sourceSpec, basepath, filelist, partials[i].pot_file));
+        }
+        for (size_t i = shards.size() > jobs ? shards.size() - jobs : 0; i < shards.size(); i++)
+            collect(i);
+
+        if (failed)
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
+
+        return partials;
+    }
+
+    /**
+        Splits @a files into contiguous ranges of roughly the same total size.
+
+        Ranges preserve the order of files, so that concatenating their
+        outputs produces the same result as processing all files at once.
+     */
+    static std::vector<FilesList> SplitIntoShards(const SourceCodeSpec& sourceSpec, const FilesList& files)
+    {
+        size_t count = std::min(GetJobsCount(), files.size() / MIN_FILES_PER_SHARD);
+        if (count <= 1)
+            return {files};
+
+        std::vector<wxULongLong_t> sizes(files.size());
+        wxULongLong_t total = 0;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            auto size = wxFileName::GetSize(sourceSpec.BasePath + files[i]);
+            // count every file as at least one block, xgettext has per-file overhead too:
+            sizes[i] = std::max(size == wxInvalidSize ? 0 : size.GetValue(), (wxULongLong_t)4096);
+            total += sizes[i];
+        }
+
+        std::vector<FilesList> shards(1);
+        wxULongLong_t accumulated = 0;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (accumulated >= total * shards.size() / count && shards.size() < count)
+                shards.emplace_back();
+            shards.back().push_back(files[i]);
+            accumulated += sizes[i];
+        }
+
+        return shards;
+    }
+
+    static wxString WriteFilesList(TempDirectory& tmpdir, const FilesList& files)
+    {
         wxTextFile filelist;
         filelist.Create(tmpdir.CreateFileName("gettext_filelist.txt"));
         for (auto fn: files)
@@ -125,8 +271,15 @@ public:
             filelist.AddLine(fn);
         }
         filelist.Write(wxTextFileType_Unix, wxConvFile);
+        return filelist.GetName();
+    }
 
-        auto outfile = tmpdir.CreateFileName("gettext.pot");
+    wxString BuildCommandLine(const SourceCodeSpec& sourceSpec,
+                              const wxString& basepath,
+                              const wxString& filelist,
+                              const wxString& outfile) const
+    {
+        using subprocess::quote_arg;
 
         wxString cmdline;
         cmdline.Printf
@@ -134,20 +287,20 @@ public:
             "xgettext --force-po -o %s --directory=%s --files-from=%s --from-code=%s",
             quote_arg(outfile),
             quote_arg(basepath),
-            quote_arg(filelist.GetName()),
+            quote_arg(filelist),
             quote_arg(!sourceSpec.Charset.empty() ? sourceSpec.Charset : "UTF-8")
         );
 
         if (check_gettext_version(0, 25))
         {
             // don't consider mtime of the temporary file passed to --files-from:
-            cmdline += wxString::Format(" --generated=%s", quote_arg(filelist.GetName()));
+            cmdline += wxString::Format(" --generated=%s", quote_arg(filelist));
         }
 
         if (check_gettext_version(0, 24, 1))
         {
-            // FIXME: This is temporary, to avoid the implied slowness. Should be amended with
-            //        calculating mtimes in parallel in Poedit itself.
+            // xgettext runs git-log serially for every file, which is very slow. POT-Creation-Date
+            // is calculated much faster by Extractor::GetSourcesModificationDate() instead.
             cmdline += " --no-git";
         }
 
@@ -173,21 +326,9 @@ public:
         if (!extraFlags.empty())
             cmdline += " " + extraFlags;
 
-        GettextRunner runner;
-        auto output = runner.run_command_sync(cmdline);
-        auto err = runner.parse_stderr(output);
-
-        if (output.failed())
-        {
-            // Total failure - don't log warnings, focus on the hard errors
-            err.log_errors();
-            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
-        }
-
-        return {outfile, err};
+        return cmdline;
     }
-    
-protected:
+
     virtual wxString GetAdditionalFlags() const = 0;
 };
 
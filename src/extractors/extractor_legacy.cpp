@@ -321,7 +321,7 @@ ExtractionOutput LegacyExtractor::Extract(TempDirectory& tmpdir,
         partials.push_back({tempfile, err});
     }
 
-    return ConcatPartials(tmpdir, partials);
+    return ConcatPartials(partials);
 }
 
 
@@ -31,8 +31,10 @@
 #include <wx/button.h>
 #include <wx/sizer.h>
 #include <wx/stattext.h>
+#include <wx/stopwatch.h>
 #include <wx/textctrl.h>
 #include <wx/checkbox.h>
+#include <wx/log.h>
 
 #ifdef __WXOSX__
 #include <AppKit/AppKit.h>
@@ -43,9 +45,14 @@
 #include <gdk/gdkkeysyms.h>
 #endif
 
-#include <regex>
+#include <unicode/uchar.h>
+
+#include <algorithm>
+#include <climits>
+#include <mutex>
 
 #include "catalog.h"
+#include "concurrency.h"
 #include "text_control.h"
 #include "edframe.h"
 #include "editing_area.h"
@@ -148,6 +155,8 @@ FindFrame::FindFrame(PoeditFrame *owner,
     m_btnClose = new wxButton(panel, wxID_CLOSE, _("Close"));
     m_btnReplaceAll = new wxButton(panel, wxID_ANY, MSW_OR_OTHER(_("Replace &all"), _("Replace &All")));
     m_btnReplace = new wxButton(panel, wxID_ANY, _("&Replace"));
+    m_btnFindAll = new wxButton(panel, wxID_ANY, MSW_OR_OTHER(_("Find &all"), _("Find &All")));
+    m_findAllResult = new wxStaticText(panel, wxID_ANY, "");
     m_btnPrev = new wxButton(panel, wxID_ANY, _("< &Previous"));
     m_btnNext = new wxButton(panel, wxID_ANY, _("&Next >"));
     m_btnNext->SetDefault();
@@ -155,7 +164,9 @@ FindFrame::FindFrame(PoeditFrame *owner,
     wxBoxSizer *buttons = new wxBoxSizer(wxHORIZONTAL);
     sizer->Add(buttons, wxSizerFlags().Expand().PXBorderAll());
     buttons->Add(m_btnClose, wxSizerFlags().PXBorder(wxRIGHT));
+    buttons->Add(m_findAllResult, wxSizerFlags().Center().PXBorder(wxRIGHT));
     buttons->AddStretchSpacer();
+    buttons->Add(m_btnFindAll, wxSizerFlags().PXBorder(wxRIGHT));
     buttons->Add(m_btnReplaceAll, wxSizerFlags().PXBorder(wxRIGHT));
     buttons->Add(m_btnReplace, wxSizerFlags().PXBorder(wxRIGHT));
     buttons->Add(m_btnPrev, wxSizerFlags().PXBorder(wxRIGHT));
@@ -227,6 +238,8 @@ FindFrame::FindFrame(PoeditFrame *owner,
 
     m_btnReplace->Bind(wxEVT_BUTTON, &FindFrame::OnReplace, this);
     m_btnReplaceAll->Bind(wxEVT_BUTTON, &FindFrame::OnReplaceAll, this);
+    m_btnFindAll->Bind(wxEVT_BUTTON, &FindFrame::OnFindAll, this);
+    m_btnFindAll->Bind(wxEVT_UPDATE_UI, [=](wxUpdateUIEvent& e){ e.Enable(!ms_text.empty()); });
     m_btnReplace->Bind(wxEVT_UPDATE_UI, [=](wxUpdateUIEvent& e){ e.Enable((bool)m_lastItem); });
     m_btnReplaceAll->Bind(wxEVT_UPDATE_UI, [=](wxUpdateUIEvent& e){ e.Enable(!ms_text.empty()); });
 
@@ -248,9 +261,12 @@ FindFrame::~FindFrame()
 
 void FindFrame::Reset(const CatalogPtr& c)
 {
+    if (c != m_catalog)
+        m_index.reset();
     m_catalog = c;
     m_position = -1;
     m_lastItem.reset();
+    m_findAllResult->SetLabel(wxString());
 
     UpdateButtons();
 }
@@ -289,6 +305,13 @@ void FindFrame::DoShowFor(int mode)
 
 void FindFrame::OnClose(wxCommandEvent&)
 {
+    // results of "Find all" are only shown while searching:
+    if (m_listCtrl && m_listCtrl->GetFilter() == PoeditListCtrl::Filter::Search)
+    {
+        m_listCtrl->SetFilter(PoeditListCtrl::Filter::All);
+        m_owner->NotifyFilterChanged();
+    }
+
     Destroy();
 }
 
@@ -308,6 +331,8 @@ void FindFrame::OnModeChanged()
 
     m_btnReplace->Show(isReplace);
     m_btnReplaceAll->Show(isReplace);
+    m_btnFindAll->Show(!isReplace);
+    m_findAllResult->Show(!isReplace);
     m_replaceField->GetContainingSizer()->Show(m_replaceField, isReplace);
 
     m_findInOrig->Enable(!isReplace);
@@ -406,44 +431,6 @@ bool FindTextInStringAndDo(S& str, const wxString& text, bool wholeWords, F&& ha
     return found;
 }
 
-bool IsTextInString(wxString str, const wxString& text,
-                    bool ignoreCase, bool wholeWords, bool ignoreAmp, bool ignoreUnderscore)
-{
-    if (str.empty())
-        return false;
-
-    if (ignoreCase)
-        str = unicode::fold_case(str);
-
-    if (ignoreAmp && str.find(_T('&')) != wxString::npos)
-    {
-        static std::wregex re(L"&(\\w)");
-        str = std::regex_replace(str::to_wstring(str), re, L"$1");
-    }
-
-    if (ignoreUnderscore && str.find(_T('_')) != wxString::npos)
-    {
-        static std::wregex re(L"_(\\w)");
-        str = std::regex_replace(str::to_wstring(str), re, L"$1");
-    }
-
-    return FindTextInStringAndDo(str, text, wholeWords,
-                                 [=](const wxString&,size_t,size_t){ return wxString::npos;/*just 1 hit*/ });
-}
-
-size_t IsTextInStrings(const wxArrayString& strs, const wxString& text,
-                     bool ignoreCase, bool wholeWords, bool ignoreAmp, bool ignoreUnderscore)
-{
-    // loop through all strings and search for the substring in them
-    for (size_t i = 0; i < strs.GetCount(); i++)
-    {
-        if (IsTextInString(strs[i], text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore))
-            return i;
-    }
-
-    return -1;
-}
-
 bool ReplaceTextInString(wxString& str, const wxString& text, bool wholeWords, const wxString& replacement)
 {
     return FindTextInStringAndDo(str, text, wholeWords,
@@ -466,6 +453,346 @@ enum FoundState
 
 } // anonymous space
 
+
+namespace
+{
+
+// Same as SEPARATORS, for searching in the index
+const char16_t INDEX_SEPARATORS[] = u" \t\r\n\\/:;.,?!\"'_|-+=(){}[]<>&#@";
+
+inline bool IsIndexSeparator(char16_t c)
+{
+    // NUL terminates fields in the index
+    return c == 0 ||
+           std::char_traits<char16_t>::find(INDEX_SEPARATORS, std::size(INDEX_SEPARATORS) - 1, c) != nullptr;
+}
+
+// Equivalent of regex_replace(s, "<mnemonic>(\\w)", "$1")
+void StripMnemonics(std::u16string& s, char16_t mnemonic)
+{
+    const size_t len = s.length();
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] == mnemonic && i + 1 < len && (u_isalnum(s[i+1]) || s[i+1] == u'_'))
+            i++;
+        s[out++] = s[i];
+    }
+    s.resize(out);
+}
+
+std::u16string NormalizeText(const wxString& str, bool ignoreCase, bool ignoreAmp, bool ignoreUnderscore)
+{
+    std::u16string s;
+    if (ignoreCase)
+    {
+        s = unicode::fold_case_to_type<std::u16string>(str);
+    }
+    else
+    {
+        auto buf = str::to_icu(str);
+        s.assign(reinterpret_cast<const char16_t*>(static_cast<const UChar*>(buf)));
+    }
+
+    if (ignoreAmp)
+        StripMnemonics(s, u'&');
+    if (ignoreUnderscore)
+        StripMnemonics(s, u'_');
+    return s;
+}
+
+// Returns first occurrence of @a c in [p, end) or @a end. Blocks of characters
+// are tested without early exit in the inner loop, which compilers vectorize.
+inline const char16_t *FindChar(const char16_t *p, const char16_t *end, char16_t c)
+{
+    const ptrdiff_t BLOCK = 16;
+    for (; end - p >= BLOCK; p += BLOCK)
+    {
+        bool any = false;
+        for (ptrdiff_t i = 0; i < BLOCK; i++)
+            any |= (p[i] == c);
+        if (any)
+            break;
+    }
+    return std::find(p, end, c);
+}
+
+} // anonymous namespace
+
+
+/**
+    Normalized (i.e. case-folded and with mnemonics removed, as requested)
+    texts of all searchable fields of all catalog's items.
+
+    The texts are kept in a single NUL-separated buffer, so that searching is
+    a single linear scan. Edited items are appended to the end of the buffer
+    and their old texts are ignored until the index is rebuilt.
+ */
+class FindFrame::SearchIndex
+{
+public:
+    // fields of an item, in the order of DoFind()'s preference
+    enum Field : uint8_t
+    {
+        Translation,
+        Source,
+        SourcePlural,
+        Context,
+        SymbolicId,
+        Comment,
+        ExtractedComment
+    };
+
+    struct Match
+    {
+        int item;           // catalog index
+        Field field;
+        unsigned subindex;  // of translation or extracted comment
+        size_t position;    // in the normalized text of the field
+    };
+
+    SearchIndex(bool ignoreCase, bool ignoreAmp, bool ignoreUnderscore)
+        : m_ignoreCase(ignoreCase), m_ignoreAmp(ignoreAmp), m_ignoreUnderscore(ignoreUnderscore)
+    {}
+
+    static bool IsFieldIncluded(Field field, bool inTrans, bool inSource, bool inComments)
+    {
+        switch (field)
+        {
+            case Translation:
+                return inTrans;
+            case Source:
+            case SourcePlural:
+            case Context:
+            case SymbolicId:
+                return inSource;
+            case Comment:
+            case ExtractedComment:
+                return inComments;
+        }
+        return false;
+    }
+
+    bool IsFor(bool ignoreCase, bool ignoreAmp, bool ignoreUnderscore) const
+    {
+        return ignoreCase == m_ignoreCase && ignoreAmp == m_ignoreAmp && ignoreUnderscore == m_ignoreUnderscore;
+    }
+
+    /// Brings the index up to date with the catalog's content
+    void Update(const Catalog& catalog)
+    {
+        auto& items = catalog.items();
+        if (items.size() != m_items.size())
+        {
+            Rebuild(catalog);
+            return;
+        }
+
+        std::vector<size_t> changed;
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            auto& e = m_items[i];
+            if (e.ptr != items[i].get() || e.generation != items[i]->GetGeneration())
+                changed.push_back(i);
+        }
+
+        if (changed.empty())
+            return;
+        if (changed.size() > items.size() / 4)
+        {
+            Rebuild(catalog);
+            return;
+        }
+
+        for (auto i: changed)
+        {
+            auto& e = m_items[i];
+            if (e.fieldsCount)
+            {
+                const size_t last = e.firstField + e.fieldsCount;
+                const size_t end = (last < m_fields.size()) ? m_fields[last].start : m_text.size();
+                m_garbage += end - m_fields[e.firstField].start;
+            }
+            AddItem(*items[i], i, m_text, m_fields);
+        }
+
+        if (m_garbage > m_text.size() / 2)
+            Rebuild(catalog);
+    }
+
+    /**
+        Calls @a onMatch(const Match&) for every non-overlapping occurrence of
+        normalized @a text. Matches in an item are reported together, in the
+        order of Field values, but items aren't in any particular order.
+     */
+    template<typename F>
+    void Find(const std::u16string& text, bool wholeWords, F&& onMatch) const
+    {
+        const size_t len = text.length();
+        if (len == 0 || m_text.size() < len)
+            return;
+
+        const char16_t *begin = m_text.data();
+        const char16_t *last = begin + m_text.size() - len + 1;  // last possible start + 1
+        const char16_t *p = begin;
+        while (p < last)
+        {
+            p = FindChar(p, last, text[0]);
+            if (p == last)
+                break;
+
+            if (std::char_traits<char16_t>::compare(p + 1, text.data() + 1, len - 1) != 0)
+            {
+                p++;
+                continue;
+            }
+
+            if (wholeWords)
+            {
+                if ((p > begin && !IsIndexSeparator(p[-1])) || !IsIndexSeparator(p[len]))
+                {
+                    p += len;
+                    continue;
+                }
+            }
+
+            const size_t pos = p - begin;
+            auto f = std::upper_bound(m_fields.begin(), m_fields.end(), pos,
+                                      [](size_t pos, const FieldEntry& e){ return pos < e.start; }) - 1;
+            auto& item = m_items[f->item];
+            const size_t fieldIndex = f - m_fields.begin();
+            if (fieldIndex >= item.firstField && fieldIndex < item.firstField + item.fieldsCount)
+                onMatch(Match{(int)f->item, f->field, f->subindex, pos - f->start});
+
+            p += len;
+        }
+    }
+
+private:
+    struct FieldEntry
+    {
+        size_t start;
+        size_t item;
+        Field field;
+        unsigned subindex;
+    };
+
+    struct ItemEntry
+    {
+        const CatalogItem *ptr = nullptr;
+        unsigned generation = 0;
+        size_t firstField = 0, fieldsCount = 0;
+    };
+
+    void AddItem(const CatalogItem& item, size_t index, std::u16string& text, std::vector<FieldEntry>& fields)
+    {
+        auto& entry = m_items[index];
+        entry.ptr = &item;
+        entry.generation = item.GetGeneration();
+        entry.firstField = fields.size();
+
+        auto add = [&](Field field, unsigned subindex, const wxString& s, bool ignoreMnemonics)
+        {
+            if (s.empty())
+                return;
+            fields.push_back({text.size(), index, field, subindex});
+            text += NormalizeText(s, m_ignoreCase, ignoreMnemonics && m_ignoreAmp, ignoreMnemonics && m_ignoreUnderscore);
+            text += u'\0';
+        };
+
+        auto& translations = item.GetTranslations();
+        for (size_t i = 0; i < translations.size(); i++)
+            add(Translation, (unsigned)i, translations[i], true);
+        add(Source, 0, item.GetString(), true);
+        if (item.HasPlural())
+            add(SourcePlural, 0, item.GetPluralString(), true);
+        add(Context, 0, item.GetContext(), true);
+        add(SymbolicId, 0, item.GetSymbolicId(), true);
+        add(Comment, 0, item.GetComment(), false);
+        auto& extracted = item.GetExtractedComments();
+        for (size_t i = 0; i < extracted.size(); i++)
+            add(ExtractedComment, (unsigned)i, extracted[i], false);
+
+        entry.fieldsCount = fields.size() - entry.firstField;
+    }
+
+    void Rebuild(const Catalog& catalog)
+    {
+        wxStopWatch sw;
+
+        auto& items = catalog.items();
+        m_items.assign(items.size(), ItemEntry());
+        m_text.clear();
+        m_fields.clear();
+        m_garbage = 0;
+
+        // Each chunk is normalized into its own buffer, they are concatenated at the end:
+        struct Chunk
+        {
+            size_t begin;
+            std::u16string text;
+            std::vector<FieldEntry> fields;
+        };
+        std::mutex mutex;
+        std::vector<Chunk> chunks;
+
+        dispatch::parallel_for(items.size(), 512, [&](size_t begin, size_t end)
+        {
+            Chunk chunk;
+            chunk.begin = begin;
+            for (size_t i = begin; i < end; i++)
+                AddItem(*items[i], i, chunk.text, chunk.fields);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks.push_back(std::move(chunk));
+        });
+
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const Chunk& a, const Chunk& b){ return a.begin < b.begin; });
+
+        size_t textSize = 0, fieldsSize = 0;
+        for (auto& c: chunks)
+        {
+            textSize += c.text.size();
+            fieldsSize += c.fields.size();
+        }
+        m_text.reserve(textSize);
+        m_fields.reserve(fieldsSize);
+
+        for (size_t n = 0; n < chunks.size(); n++)
+        {
+            auto& c = chunks[n];
+            const size_t end = (n + 1 < chunks.size()) ? chunks[n + 1].begin : items.size();
+            for (size_t i = c.begin; i < end; i++)
+                m_items[i].firstField += m_fields.size();
+            for (auto& f: c.fields)
+            {
+                f.start += m_text.size();
+                m_fields.push_back(f);
+            }
+            m_text += c.text;
+        }
+
+        wxLogTrace("poedit", "built search index of %d items in %ld ms", (int)items.size(), sw.Time());
+    }
+
+    bool m_ignoreCase, m_ignoreAmp, m_ignoreUnderscore;
+
+    std::u16string m_text;
+    std::vector<FieldEntry> m_fields;
+    std::vector<ItemEntry> m_items;
+    size_t m_garbage = 0;  // length of outdated texts in m_text
+};
+
+
+FindFrame::SearchIndex& FindFrame::GetIndex(bool ignoreCase, bool ignoreAmp, bool ignoreUnderscore)
+{
+    if (!m_index || !m_index->IsFor(ignoreCase, ignoreAmp, ignoreUnderscore))
+        m_index.reset(new SearchIndex(ignoreCase, ignoreAmp, ignoreUnderscore));
+    m_index->Update(*m_catalog);
+    return *m_index;
+}
+
 bool FindFrame::DoFind(int dir)
 {
     wxASSERT( dir == +1 || dir == -1 );
@@ -481,10 +808,9 @@ bool FindFrame::DoFind(int dir)
     bool ignoreCase = (mode == Mode_Find) && m_ignoreCase->GetValue();
     bool wholeWords = m_wholeWords->GetValue();
     bool wrapAround = m_wrapAround->GetValue();
-    size_t trans;
+    size_t trans = 0;
 
     FoundState found = Found_Not;
-    CatalogItemPtr lastItem;
 
     wxString text(ignoreCase ? unicode::fold_case(ms_text) : ms_text);
 
@@ -495,78 +821,64 @@ bool FindFrame::DoFind(int dir)
     const bool ignoreAmp = (mode == Mode_Find) && (text.Find(_T('&')) == wxNOT_FOUND);
     const bool ignoreUnderscore = (mode == Mode_Find) && (text.Find(_T('_')) == wxNOT_FOUND);
 
+    if (cnt == 0 || text.empty())
+        return false;
+
     const int posOrig = std::max(0, std::min(m_position, cnt-1));
-    m_position = posOrig + dir;
 
-    for (int tested = 0; tested < cnt; ++tested, m_position += dir)
+    // Search the whole catalog at once and pick the nearest matching row in
+    // the search direction, i.e. the one with the smallest distance:
+    auto distanceOf = [=](int row) -> int
     {
-        if (m_position < 0)
+        int d = (row - posOrig) * dir;
+        if (d <= 0)
         {
-            if (wrapAround)
-                m_position += cnt;
-            else
-                break;
+            if (!wrapAround)
+                return INT_MAX;
+            d += cnt;  // also puts posOrig itself last, as the only one of distance cnt
         }
-        else if (m_position >= cnt)
-        {
-            if (wrapAround)
-                m_position -= cnt;
-            else
-                break;
-        }
-
-        auto dt = lastItem = (*m_catalog)[m_listCtrl->ListIndexToCatalog(m_position)];
+        return d;
+    };
 
-        if (inTrans)
-        {
-            trans = IsTextInStrings(dt->GetTranslations(), text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore);
-            if (trans != (size_t)-1)
-            {
-                found = Found_InTrans;
-                break;
-            }
-        }
-        if (inSource)
-        {
-            if (IsTextInString(dt->GetString(), text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore))
-            {
-                found = Found_InOrig;
-                break;
-            }
-            if (dt->HasPlural() && IsTextInString(dt->GetPluralString(), text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore))
-            {
-                found = Found_InOrigPlural;
-                break;
-            }
-            if (IsTextInString(dt->GetContext(), text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore))
-            {
-                found = Found_InMetadata;
-                break;
-            }
-            if (IsTextInString(dt->GetSymbolicId(), text, ignoreCase, wholeWords, ignoreAmp, ignoreUnderscore))
-            {
-                found = Found_InMetadata;
-                break;
-            }
-        }
-        if (inComments)
+    int bestDistance = INT_MAX;
+    int bestItem = -1;
+    auto& index = GetIndex(ignoreCase, ignoreAmp, ignoreUnderscore);
+    index.Find(NormalizeText(ms_text, ignoreCase, false, false), wholeWords,
+               [&](const SearchIndex::Match& m)
+    {
+        if (!SearchIndex::IsFieldIncluded(m.field, inTrans, inSource, inComments))
+            return;
+
+        // first accepted match in an item is the preferred one
+        if (m.item == bestItem)
+            return;
+
+        const int row = m_listCtrl->CatalogIndexToList(m.item);
+        if (row == -1)
+            return;  // not shown in the list
+        const int d = distanceOf(row);
+        if (d >= bestDistance)
+            return;
+
+        bestDistance = d;
+        bestItem = m.item;
+        m_position = row;
+        trans = m.subindex;
+        switch (m.field)
         {
-            if (IsTextInString(dt->GetComment(), text, ignoreCase, wholeWords, false, false))
-            {
-                found = Found_InComments;
-                break;
-            }
-            if (IsTextInStrings(dt->GetExtractedComments(), text, ignoreCase, wholeWords, false, false) != (size_t)-1)
-            {
-                found = Found_InExtractedComments;
-                break;
-            }
+            case SearchIndex::Translation:      found = Found_InTrans;             break;
+            case SearchIndex::Source:           found = Found_InOrig;              break;
+            case SearchIndex::SourcePlural:     found = Found_InOrigPlural;        break;
+            case SearchIndex::Context:
+            case SearchIndex::SymbolicId:       found = Found_InMetadata;          break;
+            case SearchIndex::Comment:          found = Found_InComments;          break;
+            case SearchIndex::ExtractedComment: found = Found_InExtractedComments; break;
         }
-    }
+    });
 
     if (found != Found_Not)
     {
-        m_lastItem = lastItem;
+        auto lastItem = m_lastItem = (*m_catalog)[bestItem];
 
         m_listCtrl->EnsureVisible(m_listCtrl->ListIndexToListItem(m_position));
         m_listCtrl->SelectAndFocus(m_position);
@@ -622,6 +934,57 @@ bool FindFrame::DoFind(int dir)
     return false;
 }
 
+
+void FindFrame::OnFindAll(wxCommandEvent&)
+{
+    if (!m_listCtrl || ms_text.empty())
+        return;
+
+    bool inTrans = m_findInTrans->GetValue() && (m_catalog->HasCapability(Catalog::Cap::Translations));
+    bool inSource = m_findInOrig->GetValue();
+    bool inComments = m_findInComments->GetValue();
+    bool ignoreCase = m_ignoreCase->GetValue();
+    bool wholeWords = m_wholeWords->GetValue();
+
+    wxString text(ignoreCase ? unicode::fold_case(ms_text) : ms_text);
+    const bool ignoreAmp = text.Find(_T('&')) == wxNOT_FOUND;
+    const bool ignoreUnderscore = text.Find(_T('_')) == wxNOT_FOUND;
+
+    std::vector<SearchIndex::Match> matches;
+    auto& index = GetIndex(ignoreCase, ignoreAmp, ignoreUnderscore);
+    index.Find(NormalizeText(ms_text, ignoreCase, false, false), wholeWords,
+               [&](const SearchIndex::Match& m)
+    {
+        if (SearchIndex::IsFieldIncluded(m.field, inTrans, inSource, inComments))
+            matches.push_back(m);
+    });
+
+    std::vector<int> items;
+    items.reserve(matches.size());
+    for (auto& m: matches)
+        items.push_back(m.item);
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+
+    if (items.empty())
+    {
+        m_findAllResult->SetLabel(_("No matches"));
+        if (m_listCtrl->GetFilter() == PoeditListCtrl::Filter::Search)
+        {
+            m_listCtrl->SetFilter(PoeditListCtrl::Filter::All);
+            m_owner->NotifyFilterChanged();
+        }
+    }
+    else
+    {
+        m_findAllResult->SetLabel(wxString::Format(wxPLURAL("%d match", "%d matches", (int)matches.size()), (int)matches.size()));
+        m_listCtrl->SetFilter(PoeditListCtrl::Filter::Search, std::move(items));
+        m_owner->NotifyFilterChanged();
+        m_position = -1;
+    }
+    Layout();
+}
+
 bool FindFrame::DoReplaceInItem(CatalogItemPtr item)
 {
     bool wholeWords = m_wholeWords->GetValue();
@@ -661,16 +1024,20 @@ void FindFrame::OnReplace(wxCommandEvent&)
 
 void FindFrame::OnReplaceAll(wxCommandEvent&)
 {
-    bool replaced = false;
-    for (auto& item: m_catalog->items())
-    {
-        if (DoReplaceInItem(item))
-            replaced = true;
-    }
+    bool wholeWords = m_wholeWords->GetValue();
+    auto search = m_searchField->GetValue();
+    auto replace = m_replaceField->GetValue();
+    if (search.empty())
+        return;
 
-    if (replaced)
+    wxStopWatch sw;
+
+    // replace everything in one go and only then update the UI:
+    auto changed = m_catalog->ReplaceInTranslations([=](wxString& s)
     {
-        // FIXME: Only refresh affected items
-        m_listCtrl->RefreshAllItems();
-    }
+        return ReplaceTextInString(s, search, wholeWords, replace);
+    });
+    m_owner->NotifyItemsChanged(changed);
+
+    wxLogTrace("poedit", "replaced text in %d items in %ld ms", (int)changed.size(), sw.Time());
 }
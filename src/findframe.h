@@ -34,6 +34,7 @@
 class WXDLLIMPEXP_FWD_CORE wxButton;
 class WXDLLIMPEXP_FWD_CORE wxCheckBox;
 class WXDLLIMPEXP_FWD_CORE wxChoice;
+class WXDLLIMPEXP_FWD_CORE wxStaticText;
 class WXDLLIMPEXP_FWD_CORE wxTextCtrl;
 
 class Catalog;
@@ -85,9 +86,14 @@ class FindFrame : public wxFrame
         void OnCheckbox(wxCommandEvent &event);
         void OnReplace(wxCommandEvent &event);
         void OnReplaceAll(wxCommandEvent &event);
+        void OnFindAll(wxCommandEvent &event);
         bool DoFind(int dir);
         bool DoReplaceInItem(CatalogItemPtr item);
 
+        // Normalized text of the catalog, for fast searching
+        class SearchIndex;
+        SearchIndex& GetIndex(bool ignoreCase, bool ignoreAmp, bool ignoreUnderscore);
+
         PoeditFrame *m_owner;
         wxChoice *m_mode;
         wxTextCtrl *m_searchField, *m_replaceField;
@@ -99,7 +105,9 @@ class FindFrame : public wxFrame
         CatalogPtr m_catalog;
         int m_position;
         CatalogItemPtr m_lastItem;
-        wxButton *m_btnClose, *m_btnReplaceAll, *m_btnReplace, *m_btnPrev, *m_btnNext;
+        std::unique_ptr<SearchIndex> m_index;
+        wxButton *m_btnClose, *m_btnReplaceAll, *m_btnReplace, *m_btnFindAll, *m_btnPrev, *m_btnNext;
+        wxStaticText *m_findAllResult;
 
         // NB: this is static so that last search term is remembered
         static wxString ms_text;
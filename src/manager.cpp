@@ -48,8 +48,14 @@
 #include <wx/iconbndl.h>
 #include <wx/windowptr.h>
 #include <wx/sizer.h>
+#include <wx/file.h>
+#include <wx/filename.h>
+
+#include <cstring>
+#include <map>
 
 #include "catalog.h"
+#include "catalog_po.h"
 #include "cat_update.h"
 #include "edapp.h"
 #include "edframe.h"
@@ -57,6 +63,7 @@
 #include "menus.h"
 #include "layout_helpers.h"
 #include "progress_ui.h"
+#include "str_helpers.h"
 #include "utility.h"
 
 
@@ -91,6 +98,221 @@ public:
     }
 };
 
+
+// Statistics of a catalog file shown in the list
+struct CatalogStats
+{
+    int64_t size = -1;
+    int64_t mtime = -1;
+    int all = 0, fuzzy = 0, untranslated = 0, badtokens = 0;
+    wxString lastmodified;
+    bool failed = false;
+};
+
+
+/**
+    Cache of catalogs statistics, so that files don't have to be read again
+    when they didn't change since the last time.
+
+    Entries are keyed by file path and only valid if the file has the same
+    size and modification time. They are stored in a compact binary file in
+    the cache directory. Only used from the main thread.
+ */
+class StatsCache
+{
+public:
+    static StatsCache& Get()
+    {
+        static StatsCache instance;
+        return instance;
+    }
+
+    bool Lookup(const wxString& file, int64_t size, int64_t mtime, CatalogStats& stats) const
+    {
+        auto i = m_entries.find(file);
+        if (i == m_entries.end() || i->second.size != size || i->second.mtime != mtime)
+            return false;
+        stats = i->second;
+        return true;
+    }
+
+    void Store(const wxString& file, const CatalogStats& stats)
+    {
+        m_entries[file] = stats;
+        m_dirty = true;
+    }
+
+    void Save()
+    {
+        if (!m_dirty)
+            return;
+
+        std::string buf(MAGIC, sizeof(MAGIC));
+        Put(buf, (uint32_t)m_entries.size());
+        for (auto& e: m_entries)
+        {
+            PutString(buf, e.first);
+            Put(buf, e.second.size);
+            Put(buf, e.second.mtime);
+            Put(buf, (int32_t)e.second.all);
+            Put(buf, (int32_t)e.second.fuzzy);
+            Put(buf, (int32_t)e.second.untranslated);
+            Put(buf, (int32_t)e.second.badtokens);
+            PutString(buf, e.second.lastmodified);
+        }
+
+        wxLogNull null;
+        wxFileName::Mkdir(wxFileName(GetFileName()).GetPath(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        wxTempFile f(GetFileName());
+        if (f.IsOpened() && f.Write(buf.data(), buf.size()) && f.Commit())
+            m_dirty = false;
+    }
+
+private:
+    // identifies file format, including version:
+    static constexpr char MAGIC[8] = {'P','o','e','d','S','t','a','1'};
+
+    StatsCache() : m_dirty(false)
+    {
+        Load();
+    }
+
+    static wxString GetFileName()
+    {
+        return PoeditApp::GetCacheDir("Manager") + wxFILE_SEP_PATH + "stats.bin";
+    }
+
+    void Load()
+    {
+        wxLogNull null;
+        wxFile f;
+        if (!wxFile::Exists(GetFileName()) || !f.Open(GetFileName()))
+            return;
+
+        std::string buf(f.Length(), '\0');
+        if (f.Read(&buf[0], buf.size()) != (ssize_t)buf.size())
+            return;
+        if (buf.size() < sizeof(MAGIC) || memcmp(buf.data(), MAGIC, sizeof(MAGIC)) != 0)
+            return;
+
+        Reader r{buf.data() + sizeof(MAGIC), buf.data() + buf.size()};
+        auto count = r.Get<uint32_t>();
+        for (uint32_t i = 0; i < count && r.ok; i++)
+        {
+            auto file = r.GetString();
+            CatalogStats s;
+            s.size = r.Get<int64_t>();
+            s.mtime = r.Get<int64_t>();
+            s.all = r.Get<int32_t>();
+            s.fuzzy = r.Get<int32_t>();
+            s.untranslated = r.Get<int32_t>();
+            s.badtokens = r.Get<int32_t>();
+            s.lastmodified = r.GetString();
+            if (r.ok)
+                m_entries[file] = s;
+        }
+    }
+
+    template<typename T>
+    static void Put(std::string& buf, T value)
+    {
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void PutString(std::string& buf, const wxString& s)
+    {
+        auto utf8 = str::to_utf8(s);
+        Put(buf, (uint32_t)utf8.size());
+        buf += utf8;
+    }
+
+    struct Reader
+    {
+        const char *p, *end;
+        bool ok = true;
+
+        template<typename T>
+        T Get()
+        {
+            T value = T();
+            if (!ok || size_t(end - p) < sizeof(T))
+            {
+                ok = false;
+                return value;
+            }
+            memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return value;
+        }
+
+        wxString GetString()
+        {
+            auto len = Get<uint32_t>();
+            if (!ok || size_t(end - p) < len)
+            {
+                ok = false;
+                return wxString();
+            }
+            wxString s = str::to_wx(std::string(p, len));
+            p += len;
+            return s;
+        }
+    };
+
+    std::map<wxString, CatalogStats> m_entries;
+    bool m_dirty;
+};
+
+
+// Reads statistics without loading the catalog; can be called from any thread
+CatalogStats ReadCatalogStats(const wxString& file)
+{
+    CatalogStats stats;
+
+    // suppress error messages, we don't care about specifics of the error
+    // FIXME: *do* indicate error somehow
+    wxLogNull nullLog;
+
+    try
+    {
+        auto s = POCatalog::ReadFileStatistics(file);
+        stats.all = s.all;
+        stats.fuzzy = s.fuzzy;
+        stats.untranslated = s.untranslated;
+        stats.lastmodified = s.revisionDate;
+    }
+    catch (...)
+    {
+        // FIXME: Nicer way of showing errors, this is hacky
+        stats.lastmodified = L"⚠️ " + DescribeCurrentException();
+        stats.badtokens = 1;
+        stats.failed = true;
+    }
+
+    return stats;
+}
+
+
+void SetCatalogStatsInList(wxListCtrl *list, int i, const CatalogStats& s)
+{
+    int icon;
+    if (s.fuzzy+s.untranslated+s.badtokens == 0) icon = 2;
+    else if ((double)s.all / (s.fuzzy+s.untranslated+s.badtokens) <= 3) icon = 0;
+    else icon = 1;
+
+    wxString tmp;
+    list->SetItemImage(i, icon);
+    tmp.Printf("%i", s.all);
+    list->SetItem(i, 1, tmp);
+    tmp.Printf("%i", s.untranslated);
+    list->SetItem(i, 2, tmp);
+    tmp.Printf("%i", s.fuzzy);
+    list->SetItem(i, 3, tmp);
+    tmp.Printf("%i", s.badtokens);
+    list->SetItem(i, 4, tmp);
+    list->SetItem(i, 5, s.lastmodified);
+}
+
 } // anonymous namespace
 
 
@@ -255,6 +477,10 @@ ManagerFrame::~ManagerFrame()
                    (long)(wxIntPtr)m_listPrj->GetClientData(sel));
     }
 
+    if (m_scanCancellation)
+        m_scanCancellation->cancel();
+    StatsCache::Get().Save();
+
     ms_instance = NULL;
 }
 
@@ -287,85 +513,8 @@ void ManagerFrame::UpdateListPrj(int select)
 }
 
 
-static void AddCatalogToList(wxListCtrl *list, int i, int id, const wxString& file)
-{
-    wxConfigBase *cfg = wxConfig::Get();
-    int all = 0, fuzzy = 0, untranslated = 0, badtokens = 0;
-    wxString lastmodified;
-    time_t modtime;
-    wxString key;
-    wxString file2(file);
-    file2.Replace("/", "_");
-    file2.Replace("\\", "_");
-    // FIXME: move cache to cache file and out of *config* file!
-    key.Printf("Manager/project_%i/FilesCache/%s/", id, file2.c_str());
-
-    modtime = cfg->Read(key + "timestamp", (long)0);
-
-    if (modtime == wxFileModificationTime(file))
-    {
-        all = (int)cfg->Read(key + "all", (long)0);
-        fuzzy = (int)cfg->Read(key + "fuzzy", (long)0);
-        badtokens = (int)cfg->Read(key + "badtokens", (long)0);
-        untranslated = (int)cfg->Read(key + "untranslated", (long)0);
-        lastmodified = cfg->Read(key + "lastmodified", "?");
-    }
-    else
-    {
-        // suppress error messages, we don't care about specifics of the error
-        // FIXME: *do* indicate error somehow
-        wxLogNull nullLog;
-
-        // FIXME: don't re-load the catalog if it's already loaded in the
-        //        editor, reuse loaded instance
-        try
-        {
-            auto cat = Catalog::Create(file);
-            if (cat)
-            {
-                cat->GetStatistics(&all, &fuzzy, &badtokens, &untranslated, NULL);
-                modtime = wxFileModificationTime(file);
-                lastmodified = cat->Header().RevisionDate;
-                cfg->Write(key + "timestamp", (long)modtime);
-                cfg->Write(key + "all", (long)all);
-                cfg->Write(key + "fuzzy", (long)fuzzy);
-                cfg->Write(key + "badtokens", (long)badtokens);
-                cfg->Write(key + "untranslated", (long)untranslated);
-                cfg->Write(key + "lastmodified", lastmodified);
-            }
-        }
-        catch (...)
-        {
-            // FIXME: Nicer way of showing errors, this is hacky
-            lastmodified = L"⚠️ " + DescribeCurrentException();
-            badtokens = 1;
-        }
-    }
-
-    int icon;
-    if (fuzzy+untranslated+badtokens == 0) icon = 2;
-    else if ((double)all / (fuzzy+untranslated+badtokens) <= 3) icon = 0;
-    else icon = 1;
-
-    wxString tmp;
-    // FIXME: don't put full filename there, remove common prefix (of all
-    //        directories in project's settings)
-    list->InsertItem(i, file, icon);
-    tmp.Printf("%i", all);
-    list->SetItem(i, 1, tmp);
-    tmp.Printf("%i", untranslated);
-    list->SetItem(i, 2, tmp);
-    tmp.Printf("%i", fuzzy);
-    list->SetItem(i, 3, tmp);
-    tmp.Printf("%i", badtokens);
-    list->SetItem(i, 4, tmp);
-    list->SetItem(i, 5, lastmodified);
-}
-
 void ManagerFrame::UpdateListCat(int id)
 {
-    wxBusyCursor bcur;
-
     if (id == -1) id = m_curPrj;
 
     m_details->Show();
@@ -376,17 +525,16 @@ void ManagerFrame::UpdateListCat(int id)
     wxString key;
     key.Printf("Manager/project_%i/", id);
 
-    wxString dirs = cfg->Read(key + "Dirs", wxEmptyString);
-    wxStringTokenizer tkn(dirs, wxPATH_SEP);
+    // statistics used to be cached in the config file, clean it up:
+    if (cfg->HasGroup(key + "FilesCache"))
+        cfg->DeleteGroup(key + "FilesCache");
 
-    m_catalogs.Clear();
+    wxArrayString dirs;
+    wxStringTokenizer tkn(cfg->Read(key + "Dirs", wxEmptyString), wxPATH_SEP);
     while (tkn.HasMoreTokens())
-        wxDir::GetAllFiles(tkn.GetNextToken(), &m_catalogs,
-                           "*.po", wxDIR_FILES | wxDIR_DIRS);
+        dirs.push_back(tkn.GetNextToken());
 
-    m_catalogs.Sort();
-
-    m_listCat->Freeze();
+    m_catalogs.Clear();
 
     m_listCat->ClearAll();
     m_listCat->InsertColumn(0, _("File"));
@@ -396,19 +544,123 @@ void ManagerFrame::UpdateListCat(int id)
     m_listCat->InsertColumn(4, _("Errors"));
     m_listCat->InsertColumn(5, _("Last modified"));
 
-    // FIXME: this is time-consuming, it should be done in parallel on
-    //        multi-core/SMP systems
-    for (int i = 0; i < (int)m_catalogs.GetCount(); i++)
-        AddCatalogToList(m_listCat, i, id, m_catalogs[i]);
+    // abandon results of any previous, still running, scan:
+    if (m_scanCancellation)
+        m_scanCancellation->cancel();
+    auto cancellation = m_scanCancellation = std::make_shared<dispatch::cancellation_token>();
 
-    m_listCat->SetColumnWidth(0, wxLIST_AUTOSIZE);
-    m_listCat->SetColumnWidth(1, wxLIST_AUTOSIZE_USEHEADER);
-    m_listCat->SetColumnWidth(2, wxLIST_AUTOSIZE_USEHEADER);
-    m_listCat->SetColumnWidth(3, wxLIST_AUTOSIZE_USEHEADER);
-    m_listCat->SetColumnWidth(4, wxLIST_AUTOSIZE_USEHEADER);
-    m_listCat->SetColumnWidth(5, wxLIST_AUTOSIZE);
+    // Crawling the directories can take a while on large projects, so do it
+    // in the background, one directory per thread:
+    dispatch::async([dirs, cancellation]
+    {
+        std::vector<wxArrayString> found(dirs.size());
+        dispatch::parallel_for(dirs.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end && !cancellation->is_cancelled(); i++)
+                wxDir::GetAllFiles(dirs[i], &found[i], "*.po", wxDIR_FILES | wxDIR_DIRS);
+        });
+
+        std::vector<CatalogFile> files;
+        for (auto& paths: found)
+        {
+            for (auto& path: paths)
+            {
+                if (cancellation->is_cancelled())
+                    return files;
+                files.push_back({path,
+                                 (int64_t)wxFileName::GetSize(path).GetValue(),
+                                 (int64_t)wxFileModificationTime(path)});
+            }
+        }
+
+        std::sort(files.begin(), files.end(),
+                  [](const CatalogFile& a, const CatalogFile& b){ return a.path < b.path; });
+        return files;
+    })
+    .then_on_main([=](std::vector<CatalogFile> files)
+    {
+        if (!cancellation->is_cancelled())
+            FillListCat(files, cancellation);
+    });
+}
+
+
+void ManagerFrame::FillListCat(const std::vector<CatalogFile>& files, dispatch::cancellation_token_ptr cancellation)
+{
+    auto& cache = StatsCache::Get();
+    std::vector<int> toScan;
+
+    m_listCat->Freeze();
+
+    for (int i = 0; i < (int)files.size(); i++)
+    {
+        auto& f = files[i];
+        m_catalogs.push_back(f.path);
+
+        // FIXME: don't put full filename there, remove common prefix (of all
+        //        directories in project's settings)
+        m_listCat->InsertItem(i, f.path, -1);
+
+        CatalogStats stats;
+        if (cache.Lookup(f.path, f.size, f.mtime, stats))
+            SetCatalogStatsInList(m_listCat, i, stats);
+        else
+            toScan.push_back(i);
+    }
+
+    auto autosizeColumns = [=]
+    {
+        m_listCat->SetColumnWidth(0, wxLIST_AUTOSIZE);
+        m_listCat->SetColumnWidth(1, wxLIST_AUTOSIZE_USEHEADER);
+        m_listCat->SetColumnWidth(2, wxLIST_AUTOSIZE_USEHEADER);
+        m_listCat->SetColumnWidth(3, wxLIST_AUTOSIZE_USEHEADER);
+        m_listCat->SetColumnWidth(4, wxLIST_AUTOSIZE_USEHEADER);
+        m_listCat->SetColumnWidth(5, wxLIST_AUTOSIZE);
+    };
+    autosizeColumns();
 
     m_listCat->Thaw();
+
+    if (toScan.empty())
+        return;
+
+    wxLogTrace("poedit", "manager: scanning %d of %d files", (int)toScan.size(), (int)files.size());
+
+    // Read statistics of changed files in parallel, using the background
+    // threads pool, and show them in the list as soon as they are available:
+    dispatch::async([=]
+    {
+        dispatch::parallel_for(toScan.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t n = begin; n < end; n++)
+            {
+                if (cancellation->is_cancelled())
+                    return;
+
+                const int i = toScan[n];
+                auto file = files[i];
+                auto stats = ReadCatalogStats(file.path);
+                stats.size = file.size;
+                stats.mtime = file.mtime;
+
+                dispatch::on_main([=]
+                {
+                    if (cancellation->is_cancelled())
+                        return;
+                    if (!stats.failed)
+                        StatsCache::Get().Store(file.path, stats);
+                    SetCatalogStatsInList(m_listCat, i, stats);
+                });
+            }
+        });
+    })
+    .then_on_main([=]
+    {
+        if (cancellation->is_cancelled())
+            return;
+        autosizeColumns();
+        StatsCache::Get().Save();
+    });
 }
 
 
@@ -31,6 +31,10 @@
 #include <wx/stattext.h>
 #include <wx/string.h>
 
+#include <vector>
+
+#include "concurrency.h"
+
 class WXDLLIMPEXP_FWD_CORE wxListBox;
 
 class Catalog;
@@ -79,6 +83,16 @@ class ManagerFrame : public ManagerFrameBase
         void UpdateListPrj(int select = 0);
         /// Updates catalogs list for given project
         void UpdateListCat(int id = -1);
+
+        struct CatalogFile
+        {
+            wxString path;
+            int64_t size;
+            int64_t mtime;
+        };
+
+        /// Shows found files, with cached statistics or scanning them in the background
+        void FillListCat(const std::vector<CatalogFile>& files, dispatch::cancellation_token_ptr cancellation);
         
         void OnNewProject(wxCommandEvent& event);
         void OnEditProject(wxCommandEvent& event);
@@ -93,6 +107,7 @@ class ManagerFrame : public ManagerFrameBase
         wxStaticText *m_projectName;
         wxArrayString m_catalogs;
         int m_curPrj;
+        dispatch::cancellation_token_ptr m_scanCancellation;
 
         static ManagerFrame *ms_instance;
 };
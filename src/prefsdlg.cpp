@@ -25,6 +25,7 @@
 
 #include "prefsdlg.h"
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 
@@ -782,6 +783,17 @@ public:
         sizer->AddSpacer(PX(1));
         sizer->Add(buttonSizer, wxSizerFlags().BORDER_MACOS(wxLEFT, PX(1)));
 
+        auto jobsSizer = new wxBoxSizer(wxHORIZONTAL);
+        sizer->Add(jobsSizer, wxSizerFlags().Expand().PXDoubleBorder(wxTOP));
+        /// TRANSLATORS: Followed by a choice of number of xgettext processes to run at the same time
+        jobsSizer->Add(new wxStaticText(this, wxID_ANY, _("Parallel extraction jobs:")), wxSizerFlags().Center().BORDER_WIN(wxTOP, PX(1)));
+        jobsSizer->AddSpacer(PX(5));
+        m_jobs = new wxChoice(this, wxID_ANY);
+        m_jobs->Append(_("Automatic"));
+        for (int i = 1; i <= MAX_JOBS; i++)
+            m_jobs->Append(wxString::Format("%d", i));
+        jobsSizer->Add(m_jobs, wxSizerFlags().Center().Border(wxTOP, AboveChoicePadding()));
+
         ColorScheme::SetupWindowColors(this, [=]
         {
             customExLabel->SetForegroundColour(ExplanationLabel::GetTextColor());
@@ -800,6 +812,9 @@ public:
         m_delete->Bind(wxEVT_BUTTON, &ExtractorsPageWindow::OnDeleteExtractor, this);
 
         m_list->Bind(wxEVT_CHECKLISTBOX, &ExtractorsPageWindow::OnEnableExtractor, this);
+
+        if (wxPreferencesEditor::ShouldApplyChangesImmediately())
+            m_jobs->Bind(wxEVT_CHOICE, [=](wxCommandEvent&){ TransferDataFromWindow(); });
         m_list->Bind(wxEVT_LISTBOX_DCLICK, &ExtractorsPageWindow::OnEditExtractor, this);
 
         m_edit->Bind(wxEVT_UPDATE_UI, [=](wxUpdateUIEvent& e) { e.Enable(m_list->GetSelection() != wxNOT_FOUND); });
@@ -842,11 +857,14 @@ public:
             m_list->SetSelection(0);
             m_list->EnsureVisible(0);
         }
+
+        m_jobs->SetSelection(std::clamp(Config::ExtractionJobs(), 0, MAX_JOBS));
     }
 
     void SaveValues(wxConfigBase& cfg) override
     {
         m_extractors.Write(&cfg);
+        Config::ExtractionJobs(m_jobs->GetSelection());
     }
 
 private:
@@ -991,10 +1009,13 @@ private:
             TransferDataFromWindow();
     }
 
+    static const int MAX_JOBS = 32;
+
     LegacyExtractorsDB m_extractors;
 
     wxCheckListBox *m_list;
     wxButton *m_new, *m_edit, *m_delete;
+    wxChoice *m_jobs;
 };
 
 class ExtractorsPage : public wxPreferencesPage
@@ -130,6 +130,27 @@ inline void set_node_text(xml_node node, const std::string& text)
 }
 
 
+/// Writer that appends output directly to a string, without intermediate streams.
+struct xml_string_writer : public xml_writer
+{
+    std::string result;
+
+    void write(const void* data, size_t size) override
+    {
+        result.append(static_cast<const char*>(data), size);
+    }
+};
+
+
+/// Serializes the document into a string.
+inline std::string save_to_string(const xml_document& doc, unsigned int flags)
+{
+    xml_string_writer writer;
+    doc.save(writer, "\t", flags);
+    return std::move(writer.result);
+}
+
+
 } // namespace pugi
 
 #endif // Poedit_pugixml_h
@@ -25,9 +25,11 @@
 
 #include "qa_checks.h"
 
+#include "concurrency.h"
+#include "str_helpers.h"
 #include "syntaxhighlighter.h"
 
-#include <regex>
+#include <atomic>
 #include <set>
 #include <unicode/uchar.h>
 #include <wx/translation.h>
@@ -56,8 +58,6 @@ namespace QA
     const char *GetCheckId() const override { return GetId(); }
 
 
-std::wregex RE_POSITIONAL_FORMAT(LR"(^%[0-9]\$(.*))", std::regex_constants::ECMAScript | std::regex_constants::optimize);
-
 class Placeholders : public QACheck
 {
 public:
@@ -149,10 +149,9 @@ private:
 
             // filter out reordering of positional arguments by tracking them as unordered;
             // e.g. %1$s is translated into %s
-            std::wsmatch m;
-            if (std::regex_match(x, m, RE_POSITIONAL_FORMAT))
+            if (x.length() >= 3 && x[0] == '%' && x[1] >= '0' && x[1] <= '9' && x[2] == '$')
             {
-                x = std::wstring(L"%") + std::wstring(m[1]);
+                x.erase(1, 2);
             }
 
             ph.insert(x);
@@ -617,8 +616,9 @@ bool QACheck::CheckString(CatalogItemPtr /*item*/, const wxString& /*source*/, c
 // QAChecker
 // -------------------------------------------------------------
 
-QAChecker::QAChecker()
+QAChecker::QAChecker() : m_useCache(false), m_configFingerprint(0)
 {
+    UpdateConfigFingerprint();
 }
 
 QAChecker::~QAChecker()
@@ -630,6 +630,7 @@ std::shared_ptr<QAChecker> QAChecker::GetFor(Catalog& catalog)
 {
     auto lang = catalog.GetLanguage();
     auto c = std::make_shared<QAChecker>();
+    c->SetLanguage(lang);
 
     #define qa_instantiate(klass) c->AddCheck<klass>(lang);
     QA_ENUM_ALL_CHECKS(qa_instantiate);
@@ -651,16 +652,94 @@ std::vector<std::pair<std::string, wxString>> QAChecker::GetMetadata()
 
 int QAChecker::Check(Catalog& catalog)
 {
-    int issues = 0;
-
-    for (auto& i: catalog.items())
-        issues += Check(i);
+    // Checks only hold configuration that is immutable after construction and
+    // each item is only ever modified by the chunk that owns it, so the items
+    // can be processed in parallel without any locking. The issues found don't
+    // depend on scheduling either, because they are per-item.
+    auto& items = catalog.items();
+    std::atomic<int> issues(0);
+
+    dispatch::parallel_for(items.size(), /*min_chunk=*/256, [this,&items,&issues](size_t begin, size_t end)
+    {
+        int found = 0;
+        for (size_t i = begin; i < end; i++)
+            found += Check(items[i]);
+        issues += found;
+    });
 
     return issues;
 }
 
 
+void QAChecker::AddCheck(std::shared_ptr<QACheck> c)
+{
+    m_checks.push_back(c);
+    UpdateConfigFingerprint();
+}
+
+
+void QAChecker::SetLanguage(const Language& lang)
+{
+    m_language = lang;
+    UpdateConfigFingerprint();
+}
+
+
+void QAChecker::UpdateConfigFingerprint()
+{
+    str::hash64 h;
+    h.add(m_language.LanguageTag());
+    for (auto& c: m_checks)
+        h.add(std::string(c->GetCheckId()));
+    m_configFingerprint = h.value();
+}
+
+
+uint64_t QAChecker::GetFingerprint(const CatalogItem& item) const
+{
+    str::hash64 h;
+    h.add(m_configFingerprint);
+    h.add(item.GetString());
+    h.add((uint64_t)item.HasPlural());
+    if (item.HasPlural())
+        h.add(item.GetPluralString());
+    h.add((uint64_t)item.GetNumberOfTranslations());
+    for (auto& t: item.GetTranslations())
+        h.add(t);
+    h.add((uint64_t)item.IsTranslated());
+    h.add(item.GetFormatFlag());
+    h.add(item.GetInternalFormatFlag());
+    h.add((uint64_t)item.GetMaxLength());
+    h.add((uint64_t)item.GetMinLength());
+
+    // 0 is reserved for "never checked"
+    auto value = h.value();
+    return value ? value : 1;
+}
+
+
 int QAChecker::Check(CatalogItemPtr item)
+{
+    if (!m_useCache)
+        return DoCheck(item);
+
+    const auto fingerprint = GetFingerprint(*item);
+    if (item->GetQAFingerprint() == fingerprint)
+    {
+        auto& cached = item->GetQAIssue();
+        if (!cached)
+            return 0;
+        item->SetIssue(cached);
+        return 1;
+    }
+
+    const int issues = DoCheck(item);
+    item->SetQAResult(fingerprint, issues ? item->GetIssue() : nullptr);
+    return issues;
+}
+
+
+int QAChecker::DoCheck(CatalogItemPtr item)
 {
     int issues = 0;
 
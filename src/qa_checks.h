@@ -32,7 +32,12 @@
 #include <vector>
 
 
-/// Interface for implementing quality checks
+/**
+    Interface for implementing quality checks.
+
+    @note Implementations must be reentrant: the same instance is used
+          to check different items concurrently.
+ */
 class QACheck
 {
 public:
@@ -67,12 +72,23 @@ public:
     /// Returns metadata for the available checkers, as (id,description) pairs
     static std::vector<std::pair<std::string, wxString>> GetMetadata();
 
-    /// Checks all items. Returns # of issues found.
+    /// Checks all items, in parallel on large catalogs. Returns # of issues found.
     int Check(Catalog& catalog);
 
     /// Check a single item. Returns # of issues found.
     int Check(CatalogItemPtr item);
 
+    /**
+        Enables reuse of previous results for unchanged items.
+
+        When enabled, a fingerprint of the checked content (source and plural
+        text, translations, format flag, length limits) together with the
+        language and set of enabled checks is stored in the item along with
+        the result. Items whose fingerprint matches are not checked again,
+        the cached issue (if any) is used instead.
+     */
+    void EnableCache(bool enable = true) { m_useCache = enable; }
+
     // Low-level creation and setup:
 
     QAChecker();
@@ -85,14 +101,25 @@ public:
             AddCheck(std::make_shared<TCheck>(args...));
     }
 
-    void AddCheck(std::shared_ptr<QACheck> c) { m_checks.push_back(c); }
+    void AddCheck(std::shared_ptr<QACheck> c);
+
+    /// Sets language checked, only needed for cache fingerprinting
+    void SetLanguage(const Language& lang);
 
 private:
     template<typename TCheck>
     bool IsCheckEnabled() const { return true; }
 
+    int DoCheck(CatalogItemPtr item);
+    uint64_t GetFingerprint(const CatalogItem& item) const;
+    void UpdateConfigFingerprint();
+
 protected:
     std::vector<std::shared_ptr<QACheck>> m_checks;
+    Language m_language;
+
+    bool m_useCache;
+    uint64_t m_configFingerprint;
 };
 
 #endif // Poedit_qa_checks_h
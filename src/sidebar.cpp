@@ -912,25 +912,29 @@ void SuggestionsSidebarBlock::QueryAllProviders(const CatalogItemPtr& item)
     // are no old suggestions present right after increasing the query ID:
     m_suggestions.clear();
 
-    QueryProvider(TranslationMemory::Get(), item, thisQueryId);
+    // Local TM and any additional registered backends are queried concurrently and
+    // their results merged into the list as they arrive:
+    for (auto& q: m_provider->SuggestTranslationFromAll(CreateQuery(item)))
+        ProcessQueryResult(std::move(q), thisQueryId);
 }
 
-void SuggestionsSidebarBlock::QueryProvider(SuggestionsBackend& backend, const CatalogItemPtr& item, uint64_t queryId)
+SuggestionQuery SuggestionsSidebarBlock::CreateQuery(const CatalogItemPtr& item) const
 {
-    m_pendingQueries++;
-
-    // we need something to talk to GUI thread through that is guaranteed
-    // to exist, and the app object is a good choice:
-    auto backendPtr = &backend;
-    std::weak_ptr<SuggestionsSidebarBlock> weakSelf = std::dynamic_pointer_cast<SuggestionsSidebarBlock>(shared_from_this());
-
-    SuggestionQuery query {
+    return SuggestionQuery {
         m_parent->GetCurrentSourceLanguage(),
         m_parent->GetCurrentLanguage(),
         item->GetString().ToStdWstring()
     };
+}
+
+void SuggestionsSidebarBlock::ProcessQueryResult(BackendQuery&& query, uint64_t queryId)
+{
+    m_pendingQueries++;
+
+    auto backend = query.backend;
+    std::weak_ptr<SuggestionsSidebarBlock> weakSelf = std::dynamic_pointer_cast<SuggestionsSidebarBlock>(shared_from_this());
 
-    m_provider->SuggestTranslation(backend, std::move(query))
+    query.result
     .then_on_main([weakSelf,queryId](SuggestionsList hits)
     {
         auto self = weakSelf.lock();
@@ -941,13 +945,13 @@ void SuggestionsSidebarBlock::QueryProvider(SuggestionsBackend& backend, const C
         if (--self->m_pendingQueries == 0)
             self->OnQueriesFinished();
     })
-    .catch_all([weakSelf,queryId,backendPtr](dispatch::exception_ptr e)
+    .catch_all([weakSelf,queryId,backend](dispatch::exception_ptr e)
     {
         auto self = weakSelf.lock();
         // maybe this call is already out of date:
         if (!self || self->m_latestQueryId != queryId)
             return;
-        self->ReportError(backendPtr, e);
+        self->ReportError(backend.get(), e);
         if (--self->m_pendingQueries == 0)
             self->OnQueriesFinished();
     });
@@ -134,7 +134,8 @@ protected:
     virtual void ClearSuggestionsMenu();
 
     virtual void QueryAllProviders(const CatalogItemPtr& item);
-    void QueryProvider(SuggestionsBackend& backend, const CatalogItemPtr& item, uint64_t queryId);
+    SuggestionQuery CreateQuery(const CatalogItemPtr& item) const;
+    void ProcessQueryResult(BackendQuery&& query, uint64_t queryId);
 
     // Handle showing of suggestions
     void UpdateSuggestionsForItem(CatalogItemPtr item);
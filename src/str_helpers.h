@@ -376,6 +376,56 @@ inline std::string to_utf8(const UChar *str)
 }
 
 
+// Hashing:
+
+/**
+    Incremental 64-bit FNV-1a hash of string data.
+
+    Unlike std::hash, the value is stable across runs, so it can be used for
+    fingerprints that are persisted or compared between sessions.
+ */
+class hash64
+{
+public:
+    hash64() : m_value(0xcbf29ce484222325ULL) {}
+
+    hash64& add_bytes(const void *data, size_t length)
+    {
+        auto p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < length; i++)
+        {
+            m_value ^= p[i];
+            m_value *= 0x100000001b3ULL;
+        }
+        return *this;
+    }
+
+    hash64& add(uint64_t n) { return add_bytes(&n, sizeof(n)); }
+
+    // Strings are prefixed with their length, so that e.g. ("ab","c") and
+    // ("a","bc") sequences hash differently:
+
+    hash64& add(const std::string& s)
+    {
+        add((uint64_t)s.length());
+        return add_bytes(s.data(), s.length());
+    }
+
+    hash64& add(const std::wstring& s)
+    {
+        add((uint64_t)s.length());
+        return add_bytes(s.data(), s.length() * sizeof(wchar_t));
+    }
+
+    hash64& add(const wxString& s) { return add(to_wstring(s)); }
+
+    uint64_t value() const { return m_value; }
+
+private:
+    uint64_t m_value;
+};
+
+
 // Template-friendly API:
 
 namespace detail
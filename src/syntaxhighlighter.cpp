@@ -29,7 +29,9 @@
 #include "str_helpers.h"
 
 #include <unicode/uchar.h>
-#include <regex>
+
+#include <cstdint>
+#include <cstring>
 
 namespace
 {
@@ -141,113 +143,589 @@ private:
 
 
 
-/// Match regular expressions for highlighting
-class RegexSyntaxHighlighter : public SyntaxHighlighter
+/**
+    Hand-written, allocation-free scanners for placeholders and markup.
+
+    These replace std::regex matching, which was both slow and prone to
+    failing with error_complexity or error_stack on long strings. Each matcher
+    corresponds to a regular expression (documented next to it) and mimics its
+    ECMAScript semantics, including backtracking where it matters.
+
+    The matchers are templates that work on any buffer of UTF-16 or UTF-32
+    code units; only ASCII characters are significant for the syntax, as is
+    the case with the "C" locale used by std::regex.
+ */
+namespace scan
+{
+
+// Character classes, used in lookup table for ASCII characters:
+enum CharClass : uint32_t
+{
+    DIGIT           = 1 << 0,   // [0-9]
+    WORD            = 1 << 1,   // \w
+    SPACE           = 1 << 2,   // \s
+    ALNUM           = 1 << 3,   // [A-Za-z0-9]
+    PRINTF_FLAG     = 1 << 4,   // [-+ #0]
+    PLUS_MINUS      = 1 << 5,   // [-+]
+    C_LENGTH        = 1 << 6,   // [hljztL]
+    C_CONV          = 1 << 7,   // [%csdioxXufFeEaAgGnp]
+    PHP_CONV        = 1 << 8,   // [%bcdeEfFgGosuxX]
+    PYTHON_CONV     = 1 << 9,   // [diouxXeEfFgGcrs%]
+    PYTHON_LENGTH   = 1 << 10,  // [hlL]
+    LUA_FLAG        = 1 << 11,  // [- 0]
+    LUA_CONV        = 1 << 12,  // [sqdiouXxAaEefGgc]
+    PASCAL_CONV     = 1 << 13,  // [dDuUxXeEfFgGnNmMsSpP]
+    JS_CONV         = 1 << 14,  // [%csbdioOxXfj]
+    GO_CONV         = 1 << 15,  // [vdoOxXbcqsptTeEfFgG%]
+    D_FLAG          = 1 << 16,  // [-+ #0=]
+    D_CONV          = 1 << 17,  // [sdxXobfFeEgGaAc%]
+    HTML_TAG        = 1 << 18,  // [a-zA-Z0-9:-]
+    HTML_ATTR       = 1 << 19,  // [-:\w]
+    HTML_VALUE      = 1 << 20,  // [-:\w+]
+    COMMON_VAR      = 1 << 21,  // [\w.-]
+    BRACE_VAR       = 1 << 22   // [\w.-:,] (note that .-: is a range)
+};
+
+struct CharTable
+{
+    uint32_t classes[128];
+
+    constexpr CharTable() : classes{}
+    {
+        for (int c = '0'; c <= '9'; c++)
+            classes[c] |= DIGIT | WORD | ALNUM | HTML_TAG | HTML_ATTR | HTML_VALUE | COMMON_VAR | BRACE_VAR;
+        for (int c = 'a'; c <= 'z'; c++)
+            classes[c] |= WORD | ALNUM | HTML_TAG | HTML_ATTR | HTML_VALUE | COMMON_VAR | BRACE_VAR;
+        for (int c = 'A'; c <= 'Z'; c++)
+            classes[c] |= WORD | ALNUM | HTML_TAG | HTML_ATTR | HTML_VALUE | COMMON_VAR | BRACE_VAR;
+        classes['_'] |= WORD | HTML_ATTR | HTML_VALUE | COMMON_VAR | BRACE_VAR;
+
+        for (auto c: " \t\n\v\f\r") classes[(int)c] |= SPACE;
+        for (auto c: "-+ #0")       classes[(int)c] |= PRINTF_FLAG;
+        for (auto c: "-+")          classes[(int)c] |= PLUS_MINUS;
+        for (auto c: "hljztL")      classes[(int)c] |= C_LENGTH;
+        for (auto c: "%csdioxXufFeEaAgGnp")  classes[(int)c] |= C_CONV;
+        for (auto c: "%bcdeEfFgGosuxX")      classes[(int)c] |= PHP_CONV;
+        for (auto c: "diouxXeEfFgGcrs%")     classes[(int)c] |= PYTHON_CONV;
+        for (auto c: "hlL")                  classes[(int)c] |= PYTHON_LENGTH;
+        for (auto c: "- 0")                  classes[(int)c] |= LUA_FLAG;
+        for (auto c: "sqdiouXxAaEefGgc")     classes[(int)c] |= LUA_CONV;
+        for (auto c: "dDuUxXeEfFgGnNmMsSpP") classes[(int)c] |= PASCAL_CONV;
+        for (auto c: "%csbdioOxXfj")         classes[(int)c] |= JS_CONV;
+        for (auto c: "vdoOxXbcqsptTeEfFgG%") classes[(int)c] |= GO_CONV;
+        for (auto c: "-+ #0=")               classes[(int)c] |= D_FLAG;
+        for (auto c: "sdxXobfFeEgGaAc%")     classes[(int)c] |= D_CONV;
+        for (auto c: ":-")                   classes[(int)c] |= HTML_TAG | HTML_ATTR | HTML_VALUE;
+        classes['+'] |= HTML_VALUE;
+        for (auto c: ".-")                   classes[(int)c] |= COMMON_VAR;
+        for (auto c: "./:,")                 classes[(int)c] |= BRACE_VAR;
+
+        classes[0] = 0; // terminating NULs of the literals above
+    }
+};
+
+constexpr CharTable TABLE;
+
+template<typename CharT>
+inline bool is(CharT c, uint32_t cls)
+{
+    const auto code = static_cast<uint32_t>(c);
+    return code < 128 && (TABLE.classes[code] & cls);
+}
+
+
+/// Position in the scanned text, with helpers for matching regex constructs
+template<typename CharT>
+class cursor
 {
 public:
-    static const std::wregex::flag_type flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+    cursor(const CharT *p, const CharT *end) : m_start(p), m_p(p), m_end(end) {}
 
-    RegexSyntaxHighlighter(const wchar_t *regex, TextKind kind) : m_re(regex, flags), m_kind(kind) {}
-    RegexSyntaxHighlighter(const std::wregex& regex, TextKind kind) : m_re(regex), m_kind(kind) {}
+    const CharT *pos() const { return m_p; }
+    void reset(const CharT *p) { m_p = p; }
+    size_t length() const { return size_t(m_p - m_start); }
 
-    void Highlight(const std::wstring& s, const CallbackType& highlight) override
+    /// Returns n-th character from current position, or 0 if out of range
+    CharT peek(size_t n = 0) const { return size_t(m_end - m_p) > n ? m_p[n] : CharT(0); }
+
+    /// Matches literal ASCII character
+    bool eat(char c)
     {
-        try
+        if (m_p == m_end || *m_p != CharT(c))
+            return false;
+        ++m_p;
+        return true;
+    }
+
+    /// Matches single character of given class
+    bool eat_class(uint32_t cls)
+    {
+        if (m_p == m_end || !is(*m_p, cls))
+            return false;
+        ++m_p;
+        return true;
+    }
+
+    /// Matches up to @a max characters of given class, returns their count
+    size_t eat_many(uint32_t cls, size_t max = SIZE_MAX)
+    {
+        auto start = m_p;
+        while (m_p != m_end && size_t(m_p - start) < max && is(*m_p, cls))
+            ++m_p;
+        return size_t(m_p - start);
+    }
+
+    /// Matches any character except line terminators, like '.' in regex
+    bool eat_any()
+    {
+        if (m_p == m_end)
+            return false;
+        switch (*m_p)
         {
-            std::wsregex_iterator next(s.begin(), s.end(), m_re);
-            std::wsregex_iterator end;
-            while (next != end)
-            {
-                auto match = *next++;
-                if (match.empty())
-                    continue;
-                int pos = static_cast<int>(match.position());
-                highlight(pos, pos + static_cast<int>(match.length()), m_kind);
-            }
+            case '\n':
+            case '\r':
+            case 0x2028:
+            case 0x2029:
+                return false;
+            default:
+                ++m_p;
+                return true;
         }
-        catch (std::regex_error& e)
+    }
+
+    /// Skips characters not in @a stop, like [^...]* in regex
+    void skip_until(const char *stop)
+    {
+        for ( ; m_p != m_end; ++m_p)
         {
-            switch (e.code())
+            for (auto s = stop; *s; ++s)
             {
-                case std::regex_constants::error_complexity:
-                case std::regex_constants::error_stack:
-                    // MSVC version of std::regex in particular can fail to match
-                    // e.g. HTML regex with backreferences on insanely large strings;
-                    // in that case, don't highlight instead of failing outright.
+                if (*m_p == CharT(*s))
                     return;
-                default:
-                    throw;
             }
         }
     }
 
+    /// Matches quoted string, e.g. "[^"]*"
+    bool eat_quoted(char quote)
+    {
+        auto start = m_p;
+        const char stop[2] = {quote, 0};
+        if (eat(quote))
+        {
+            skip_until(stop);
+            if (eat(quote))
+                return true;
+        }
+        reset(start);
+        return false;
+    }
+
+    // Optional parts common to printf-like formats:
+
+    /// (\d+\$)?
+    void eat_position()
+    {
+        auto start = m_p;
+        if (!(eat_many(DIGIT) && eat('$')))
+            reset(start);
+    }
+
+    /// (\d+|\*)?
+    void eat_width()
+    {
+        if (!eat_many(DIGIT))
+            eat('*');
+    }
+
+    /// (\.(\d+|\*))?
+    void eat_precision()
+    {
+        auto start = m_p;
+        if (!(eat('.') && (eat_many(DIGIT) || eat('*'))))
+            reset(start);
+    }
+
 private:
-    std::wregex m_re;
-    TextKind m_kind;
+    const CharT *m_start, *m_p, *m_end;
 };
 
 
-std::wregex REOBJ_HTML_MARKUP(LR"((<\/?[a-zA-Z0-9:-]+(\s+[-:\w]+(=([-:\w+]|"[^"]*"|'[^']*'))?)*\s*\/?>)|(&[^ ;]+;))",
-                              RegexSyntaxHighlighter::flags);
+// All matchers take the start of a potential match (which is guaranteed to be
+// one of the highlighter's trigger characters) and return length of the match
+// found there, or 0 if there's none.
+
+/// <\/?[a-zA-Z0-9:-]+(\s+[-:\w]+(=([-:\w+]|"[^"]*"|'[^']*'))?)*\s*\/?>|&[^ ;]+;
+template<typename CharT>
+size_t html_markup(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+
+    if (c.eat('&'))
+    {
+        c.skip_until(" ;");
+        return (c.length() > 1 && c.eat(';')) ? c.length() : 0;
+    }
+
+    if (!c.eat('<'))
+        return 0;
+    c.eat('/');
+    if (!c.eat_many(HTML_TAG))
+        return 0;
+
+    for (;;)
+    {
+        auto attrStart = c.pos();
+        if (!(c.eat_many(SPACE) && c.eat_many(HTML_ATTR)))
+        {
+            c.reset(attrStart);
+            break;
+        }
+
+        auto valueStart = c.pos();
+        if (c.eat('=') && !c.eat_class(HTML_VALUE) && !c.eat_quoted('"') && !c.eat_quoted('\''))
+            c.reset(valueStart);
+    }
+
+    c.eat_many(SPACE);
+    c.eat('/');
+    return c.eat('>') ? c.length() : 0;
+}
 
-// variables expansion for various template languages
-std::wregex REOBJ_COMMON_PLACEHOLDERS(
-                //
-                //           |             |
-                LR"(%[\w.-]+%|%?\{[\w.-]+\}|\{\{[\w.-]+\}\})",
-                //      |    |      |      |        |
-                //      |           |               |
-                //      |           |               +----------------------- {{var}}
-                //      |           |
-                //      |           +--------------------------------------- %{var} (Ruby) and {var}
-                //      |
-                //      +--------------------------------------------------- %var% (Twig)
-                //
-                RegexSyntaxHighlighter::flags);
-const wchar_t* COMMON_PLACEHOLDERS_TRIGGER_CHARS = L"{%";
+/// %[\w.-]+%|%?\{[\w.-]+\}|\{\{[\w.-]+\}\}
+template<typename CharT>
+size_t common_placeholders(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
 
-// WebExtension-like $foo$ placeholders
-std::wregex REOBJ_DOLLAR_PLACEHOLDERS(LR"(\$[A-Za-z0-9_]+\$)", RegexSyntaxHighlighter::flags);
+    if (c.eat('%'))
+    {
+        if (c.eat_many(COMMON_VAR) && c.eat('%'))
+            return c.length();
+        c.reset(p + 1);
+        return (c.eat('{') && c.eat_many(COMMON_VAR) && c.eat('}')) ? c.length() : 0;
+    }
 
-// php-format per http://php.net/manual/en/function.sprintf.php plus positionals
-const wchar_t* RE_PHP_FORMAT = LR"(%(\d+\$)?[-+]{0,2}([ 0]|'.)?-?\d*(\..?\d+)?[%bcdeEfFgGosuxX])";
+    if (!c.eat('{'))
+        return 0;
+    if (c.eat_many(COMMON_VAR) && c.eat('}'))
+        return c.length();
+    c.reset(p + 1);
+    return (c.eat('{') && c.eat_many(COMMON_VAR) && c.eat('}') && c.eat('}')) ? c.length() : 0;
+}
 
-// c-format per http://en.cppreference.com/w/cpp/io/c/fprintf,
-//              http://pubs.opengroup.org/onlinepubs/9699919799/functions/fprintf.html
-#define RE_C_FORMAT_BASE LR"(%(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?((hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp]|<[A-Za-z0-9]+>))"
-const wchar_t* RE_C_FORMAT = RE_C_FORMAT_BASE;
-const wchar_t* RE_OBJC_FORMAT =  L"%@|" RE_C_FORMAT_BASE;
-const wchar_t* RE_CXX20_OR_RUST_FORMAT = LR"((\{\{)|(\}\})|(\{[^}]*\}))";
+/// \$[A-Za-z0-9_]+\$
+template<typename CharT>
+size_t dollar_placeholders(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    return (c.eat('$') && c.eat_many(WORD) && c.eat('$')) ? c.length() : 0;
+}
 
-// Python and Perl-libintl braces format (also covered by common placeholders above)
-#define RE_BRACES LR"(\{[\w.-:,]+\})"
+/// %(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?((hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp]|<[A-Za-z0-9]+>)
+/// (the <...> alternative for PRI* macros is only in c-format, not ruby-format)
+template<typename CharT, bool PRIMacros>
+size_t c_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
 
-// python-format old style https://docs.python.org/2/library/stdtypes.html#string-formatting
-//               new style https://docs.python.org/3/library/string.html#format-string-syntax
-const wchar_t* RE_PYTHON_FORMAT = LR"((%(\(\w+\))?[-+ #0]?(\d+|\*)?(\.(\d+|\*))?[hlL]?[diouxXeEfFgGcrs%]))" // old style
-                                  "|"
-                                  RE_BRACES; // new style
+    c.eat_position();
+    c.eat_many(PRINTF_FLAG, 5);
+    c.eat_width();
+    c.eat_precision();
 
-// ruby-format per https://ruby-doc.org/core-2.7.1/Kernel.html#method-i-sprintf
-const wchar_t* RE_RUBY_FORMAT = LR"(%(\d+\$)?[-+ #0]{0,5}(\d+|\*)?(\.(\d+|\*))?(hh|ll|[hljztL])?[%csdioxXufFeEaAgGnp])";
+    if (PRIMacros && c.peek() == '<')
+    {
+        c.eat('<');
+        return (c.eat_many(ALNUM) && c.eat('>')) ? c.length() : 0;
+    }
+
+    const auto len = c.peek();
+    if ((len == 'h' || len == 'l') && c.peek(1) == len)
+        c.eat_many(C_LENGTH, 2);
+    else
+        c.eat_class(C_LENGTH);
 
-// Qt and KDE formats
-const wchar_t* RE_QT_FORMAT = LR"(%L?(\d\d?|n))";
+    return c.eat_class(C_CONV) ? c.length() : 0;
+}
+
+/// %@|<c-format>
+template<typename CharT>
+size_t objc_format(const CharT *p, const CharT *end)
+{
+    if (end - p >= 2 && p[0] == '%' && p[1] == '@')
+        return 2;
+    return c_format<CharT, true>(p, end);
+}
 
-// Lua
-const wchar_t* RE_LUA_FORMAT = LR"(%[- 0]*\d*(\.\d+)?[sqdiouXxAaEefGgc])";
+/// %(\d+\$)?[-+]{0,2}([ 0]|'.)?-?\d*(\..?\d+)?[%bcdeEfFgGosuxX]
+template<typename CharT>
+size_t php_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
 
-// Pascal per https://www.freepascal.org/docs-html/rtl/sysutils/format.html
-const wchar_t* RE_PASCAL_FORMAT = LR"(%(\*:|\d*:)?-?(\*|\d+)?(\.\*|\.\d+)?[dDuUxXeEfFgGnNmMsSpP])";
+    c.eat_position();
+    c.eat_many(PLUS_MINUS, 2);
 
-// JavaScript format per https://www.gnu.org/software/gettext/manual/html_node/javascript_002dformat.html
-const wchar_t* RE_JAVASCRIPT_FORMAT = LR"(%[%csbdioOxXfj])";
+    if (!c.eat(' ') && !c.eat('0'))
+    {
+        auto padStart = c.pos();
+        if (!(c.eat('\'') && c.eat_any()))
+            c.reset(padStart);
+    }
 
-// Go format per https://pkg.go.dev/fmt
-const wchar_t* RE_GO_FORMAT = LR"(%[-+ #0]*(\d+|\*)?(\.(\d+|\*))?[vdoOxXbcqsptTeEfFgG%])";
+    c.eat('-');
+    c.eat_many(DIGIT);
 
-// D format per https://dlang.org/library/std/format.html
-const wchar_t* RE_D_FORMAT = LR"(%(\d+\$)?[-+ #0=]*(\d+|\*)?(\.(\d+|\*))?([sdxXobfFeEgGaAc%]|\([^%]*(%[^%|)]*(%\|[^%)]*)?)%\)))";
+    auto precisionStart = c.pos();
+    if (c.eat('.'))
+    {
+        // .? is greedy, but gives the character back if \d+ doesn't match after it
+        // (as in "%.2f") -- try both:
+        auto afterDot = c.pos();
+        if (!(c.eat_any() && c.eat_many(DIGIT) && is(c.peek(), PHP_CONV)))
+        {
+            c.reset(afterDot);
+            if (!c.eat_many(DIGIT))
+                c.reset(precisionStart);
+        }
+    }
+
+    return c.eat_class(PHP_CONV) ? c.length() : 0;
+}
+
+/// \{[\w.-:,]+\}
+template<typename CharT>
+size_t braces_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    return (c.eat('{') && c.eat_many(BRACE_VAR) && c.eat('}')) ? c.length() : 0;
+}
+
+/// (%(\(\w+\))?[-+ #0]?(\d+|\*)?(\.(\d+|\*))?[hlL]?[diouxXeEfFgGcrs%])|\{[\w.-:,]+\}
+template<typename CharT>
+size_t python_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return braces_format(p, end);
+
+    auto mappingStart = c.pos();
+    if (!(c.eat('(') && c.eat_many(WORD) && c.eat(')')))
+        c.reset(mappingStart);
+
+    c.eat_class(PRINTF_FLAG);
+    c.eat_width();
+    c.eat_precision();
+    c.eat_class(PYTHON_LENGTH);
+
+    return c.eat_class(PYTHON_CONV) ? c.length() : 0;
+}
+
+/// (\{\{)|(\}\})|(\{[^}]*\})
+template<typename CharT>
+size_t cxx20_or_rust_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (c.peek() == c.peek(1))
+        return 2; // {{ or }}
+
+    if (!c.eat('{'))
+        return 0;
+    c.skip_until("}");
+    return c.eat('}') ? c.length() : 0;
+}
+
+/// %L?(\d\d?|n)
+template<typename CharT>
+size_t qt_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
+
+    c.eat('L');
+    if (c.eat_class(DIGIT))
+    {
+        c.eat_class(DIGIT);
+        return c.length();
+    }
+
+    return c.eat('n') ? c.length() : 0;
+}
+
+/// %[- 0]*\d*(\.\d+)?[sqdiouXxAaEefGgc]
+template<typename CharT>
+size_t lua_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
+
+    c.eat_many(LUA_FLAG);
+    c.eat_many(DIGIT);
+
+    auto precisionStart = c.pos();
+    if (!(c.eat('.') && c.eat_many(DIGIT)))
+        c.reset(precisionStart);
+
+    return c.eat_class(LUA_CONV) ? c.length() : 0;
+}
+
+/// %(\*:|\d*:)?-?(\*|\d+)?(\.\*|\.\d+)?[dDuUxXeEfFgGnNmMsSpP]
+template<typename CharT>
+size_t pascal_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
+
+    auto indexStart = c.pos();
+    if (!(c.eat('*') && c.eat(':')))
+    {
+        c.reset(indexStart);
+        c.eat_many(DIGIT);
+        if (!c.eat(':'))
+            c.reset(indexStart);
+    }
+
+    c.eat('-');
+    if (!c.eat('*'))
+        c.eat_many(DIGIT);
+    c.eat_precision();
+
+    return c.eat_class(PASCAL_CONV) ? c.length() : 0;
+}
+
+/// %[%csbdioOxXfj]
+template<typename CharT>
+size_t javascript_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    return (c.eat('%') && c.eat_class(JS_CONV)) ? c.length() : 0;
+}
+
+/// %[-+ #0]*(\d+|\*)?(\.(\d+|\*))?[vdoOxXbcqsptTeEfFgG%]
+template<typename CharT>
+size_t go_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
+
+    c.eat_many(PRINTF_FLAG);
+    c.eat_width();
+    c.eat_precision();
+
+    return c.eat_class(GO_CONV) ? c.length() : 0;
+}
+
+/// %(\d+\$)?[-+ #0=]*(\d+|\*)?(\.(\d+|\*))?([sdxXobfFeEgGaAc%]|\([^%]*(%[^%|)]*(%\|[^%)]*)?)%\))
+template<typename CharT>
+size_t d_format(const CharT *p, const CharT *end)
+{
+    cursor<CharT> c(p, end);
+    if (!c.eat('%'))
+        return 0;
+
+    c.eat_position();
+    c.eat_many(D_FLAG);
+    c.eat_width();
+    c.eat_precision();
+
+    if (c.eat_class(D_CONV))
+        return c.length();
+
+    // compound format specifier, e.g. %(%s%|, %)
+    if (!c.eat('('))
+        return 0;
+    c.skip_until("%");
+    if (!c.eat('%'))
+        return 0;
+    c.skip_until("%|)");
+
+    auto separatorStart = c.pos();
+    if (c.eat('%') && c.eat('|'))
+        c.skip_until("%)");
+    else
+        c.reset(separatorStart);
+
+    return (c.eat('%') && c.eat(')')) ? c.length() : 0;
+}
+
+
+/// Returns true if @a s (using any character type) contains match of the matcher
+template<typename CharT, typename Matcher>
+bool search(const CharT *begin, const CharT *end, const char *triggers, Matcher match)
+{
+    for (auto p = begin; p < end; ++p)
+    {
+        const auto code = static_cast<uint32_t>(*p);
+        if (code != 0 && code < 128 && std::strchr(triggers, (char)code) && match(p, end))
+            return true;
+    }
+    return false;
+}
+
+} // namespace scan
+
+
+/// Highlights matches found by one of the scanners above
+class ScannerSyntaxHighlighter : public SyntaxHighlighter
+{
+public:
+    typedef size_t (*MatchFunc)(const wchar_t *p, const wchar_t *end);
+
+    /// @a triggers are the characters a match can start with
+    ScannerSyntaxHighlighter(const char *triggers, MatchFunc match, TextKind kind)
+        : m_triggers{}, m_match(match), m_kind(kind)
+    {
+        for ( ; *triggers; ++triggers)
+            m_triggers[(int)*triggers] = true;
+    }
+
+    void Highlight(const std::wstring& s, const CallbackType& highlight) override
+    {
+        const wchar_t *begin = s.data();
+        const wchar_t *end = begin + s.length();
+
+        const wchar_t *p = begin;
+        while (p < end)
+        {
+            const auto code = static_cast<uint32_t>(*p);
+            if (code < 128 && m_triggers[code])
+            {
+                if (auto len = m_match(p, end))
+                {
+                    const int pos = int(p - begin);
+                    highlight(pos, pos + int(len), m_kind);
+                    p += len;
+                    continue;
+                }
+            }
+            ++p;
+        }
+    }
+
+private:
+    bool m_triggers[128];
+    MatchFunc m_match;
+    TextKind m_kind;
+};
+
+
+const char *HTML_MARKUP_TRIGGER_CHARS = "<&";
+const char *COMMON_PLACEHOLDERS_TRIGGER_CHARS = "{%";
+
+template<typename Matcher>
+inline bool ContainsMatch(const std::wstring& s, const char *triggers, Matcher match)
+{
+    return scan::search(s.data(), s.data() + s.length(), triggers, match);
+}
 
 } // anonymous namespace
 
@@ -264,14 +742,14 @@ SyntaxHighlighterPtr SyntaxHighlighter::ForItem(const CatalogItem& item, int kin
         needsHTML = false;
 
         str::wstring_conv_t str1 = str::to_wstring(item.GetString());
-        if (str1.find(L"<") != std::wstring::npos && std::regex_search(str1, REOBJ_HTML_MARKUP))
+        if (str1.find(L"<") != std::wstring::npos && ContainsMatch(str1, HTML_MARKUP_TRIGGER_CHARS, scan::html_markup<wchar_t>))
         {
             needsHTML = true;
         }
         else if (item.HasPlural())
         {
             str::wstring_conv_t strp = str::to_wstring(item.GetString());
-            if (strp.find(L"<") != std::wstring::npos && std::regex_search(strp, REOBJ_HTML_MARKUP))
+            if (strp.find(L"<") != std::wstring::npos && ContainsMatch(strp, HTML_MARKUP_TRIGGER_CHARS, scan::html_markup<wchar_t>))
             {
                 needsHTML = true;
             }
@@ -290,14 +768,14 @@ SyntaxHighlighterPtr SyntaxHighlighter::ForItem(const CatalogItem& item, int kin
             needsGenericPlaceholders = false;
 
             str::wstring_conv_t str1 = str::to_wstring(item.GetString());
-            if (str1.find_first_of(COMMON_PLACEHOLDERS_TRIGGER_CHARS) != std::wstring::npos && std::regex_search(str1, REOBJ_COMMON_PLACEHOLDERS))
+            if (ContainsMatch(str1, COMMON_PLACEHOLDERS_TRIGGER_CHARS, scan::common_placeholders<wchar_t>))
             {
 				needsGenericPlaceholders = true;
 			}
             else if (item.HasPlural())
             {
                 str::wstring_conv_t strp = str::to_wstring(item.GetString());
-                if (strp.find_first_of(COMMON_PLACEHOLDERS_TRIGGER_CHARS) != std::wstring::npos && std::regex_search(strp, REOBJ_COMMON_PLACEHOLDERS))
+                if (ContainsMatch(strp, COMMON_PLACEHOLDERS_TRIGGER_CHARS, scan::common_placeholders<wchar_t>))
                 {
                     needsGenericPlaceholders = true;
                 }
@@ -319,14 +797,14 @@ SyntaxHighlighterPtr SyntaxHighlighter::ForItem(const CatalogItem& item, int kin
     // HTML goes first, has lowest priority than special-purpose stuff like format strings:
     if (needsHTML)
     {
-        static auto html = std::make_shared<RegexSyntaxHighlighter>(REOBJ_HTML_MARKUP, TextKind::Markup);
+        static auto html = std::make_shared<ScannerSyntaxHighlighter>(HTML_MARKUP_TRIGGER_CHARS, scan::html_markup<wchar_t>, TextKind::Markup);
         all->Add(html);
     }
 
     if (needsGenericPlaceholders)
     {
         // If no format specified, heuristically apply highlighting of common variable markers
-        static auto placeholders = std::make_shared<RegexSyntaxHighlighter>(REOBJ_COMMON_PLACEHOLDERS, TextKind::Placeholder);
+        static auto placeholders = std::make_shared<ScannerSyntaxHighlighter>(COMMON_PLACEHOLDERS_TRIGGER_CHARS, scan::common_placeholders<wchar_t>, TextKind::Placeholder);
         all->Add(placeholders);
     }
 
@@ -334,72 +812,72 @@ SyntaxHighlighterPtr SyntaxHighlighter::ForItem(const CatalogItem& item, int kin
     {
         if (fmt == "php")
         {
-            static auto php_format = std::make_shared<RegexSyntaxHighlighter>(RE_PHP_FORMAT, TextKind::Placeholder);
+            static auto php_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::php_format<wchar_t>, TextKind::Placeholder);
             all->Add(php_format);
         }
         else if (fmt == "c")
         {
-            static auto c_format = std::make_shared<RegexSyntaxHighlighter>(RE_C_FORMAT, TextKind::Placeholder);
+            static auto c_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::c_format<wchar_t, true>, TextKind::Placeholder);
             all->Add(c_format);
         }
         else if (fmt == "c++" || fmt == "rust")
         {
-            static auto cxx_rust_format = std::make_shared<RegexSyntaxHighlighter>(RE_CXX20_OR_RUST_FORMAT, TextKind::Placeholder);
+            static auto cxx_rust_format = std::make_shared<ScannerSyntaxHighlighter>("{}", scan::cxx20_or_rust_format<wchar_t>, TextKind::Placeholder);
             all->Add(cxx_rust_format);
         }
         else if (fmt == "python")
         {
-            static auto python_format = std::make_shared<RegexSyntaxHighlighter>(RE_PYTHON_FORMAT, TextKind::Placeholder);
+            static auto python_format = std::make_shared<ScannerSyntaxHighlighter>("%{", scan::python_format<wchar_t>, TextKind::Placeholder);
             all->Add(python_format);
         }
         else if (fmt == "ruby")
         {
-            static auto ruby_format = std::make_shared<RegexSyntaxHighlighter>(RE_RUBY_FORMAT, TextKind::Placeholder);
+            static auto ruby_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::c_format<wchar_t, false>, TextKind::Placeholder);
             all->Add(ruby_format);
         }
         else if (fmt == "objc")
         {
-            static auto objc_format = std::make_shared<RegexSyntaxHighlighter>(RE_OBJC_FORMAT, TextKind::Placeholder);
+            static auto objc_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::objc_format<wchar_t>, TextKind::Placeholder);
             all->Add(objc_format);
         }
         else if (fmt == "qt" || fmt == "qt-plural" || fmt == "kde" || fmt == "kde-kuit")
         {
-            static auto qt_format = std::make_shared<RegexSyntaxHighlighter>(RE_QT_FORMAT, TextKind::Placeholder);
+            static auto qt_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::qt_format<wchar_t>, TextKind::Placeholder);
             all->Add(qt_format);
         }
         else if (fmt == "lua")
         {
-            static auto lua_format = std::make_shared<RegexSyntaxHighlighter>(RE_LUA_FORMAT, TextKind::Placeholder);
+            static auto lua_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::lua_format<wchar_t>, TextKind::Placeholder);
             all->Add(lua_format);
         }
         else if (fmt == "csharp" || fmt == "perl-brace" || fmt == "python-brace")
         {
-            static auto brace_format = std::make_shared<RegexSyntaxHighlighter>(RE_BRACES, TextKind::Placeholder);
+            static auto brace_format = std::make_shared<ScannerSyntaxHighlighter>("{", scan::braces_format<wchar_t>, TextKind::Placeholder);
             all->Add(brace_format);
         }
         else if (fmt == "object-pascal")
         {
-            static auto pascal_format = std::make_shared<RegexSyntaxHighlighter>(RE_PASCAL_FORMAT, TextKind::Placeholder);
+            static auto pascal_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::pascal_format<wchar_t>, TextKind::Placeholder);
             all->Add(pascal_format);
         }
         else if (fmt == "javascript")
         {
-            static auto javascript_format = std::make_shared<RegexSyntaxHighlighter>(RE_JAVASCRIPT_FORMAT, TextKind::Placeholder);
+            static auto javascript_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::javascript_format<wchar_t>, TextKind::Placeholder);
             all->Add(javascript_format);
         }
         else if (fmt == "go")
         {
-            static auto go_format = std::make_shared<RegexSyntaxHighlighter>(RE_GO_FORMAT, TextKind::Placeholder);
+            static auto go_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::go_format<wchar_t>, TextKind::Placeholder);
             all->Add(go_format);
         }
         else if (fmt == "d")
         {
-            static auto d_format = std::make_shared<RegexSyntaxHighlighter>(RE_D_FORMAT, TextKind::Placeholder);
+            static auto d_format = std::make_shared<ScannerSyntaxHighlighter>("%", scan::d_format<wchar_t>, TextKind::Placeholder);
             all->Add(d_format);
         }
         else if (fmt == "ph-dollars")
         {
-            static auto dollars_format = std::make_shared<RegexSyntaxHighlighter>(REOBJ_DOLLAR_PLACEHOLDERS, TextKind::Placeholder);
+            static auto dollars_format = std::make_shared<ScannerSyntaxHighlighter>("$", scan::dollar_placeholders<wchar_t>, TextKind::Placeholder);
             all->Add(dollars_format);
         }
     }
@@ -26,8 +26,13 @@
 #include "text_control.h"
 
 #include <wx/clipbrd.h>
+#include <wx/stopwatch.h>
 #include <wx/wupdlock.h>
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
 #ifdef __WXOSX__
   #import <AppKit/NSTextView.h>
   #import <Foundation/NSUndoManager.h>
@@ -607,6 +612,7 @@ AnyTranslatableTextCtrl::AnyTranslatableTextCtrl(wxWindow *parent, wxWindowID wi
     ColorScheme::SetupWindowColors(this, [=]
     {
         m_attrs.reset(new Attributes(this));
+        InvalidateHighlighting();
         HighlightText();
     });
 
@@ -823,6 +829,8 @@ void AnyTranslatableTextCtrl::DoPasteText(long from, long to, const wxString& s)
     DisableAutomaticSubstitutions disableAuto(this);
 #endif
 
+    // pasted text may partially match what it replaces, defeating incremental update:
+    InvalidateHighlighting();
     Replace(from, to, EscapePlainText(bidi::strip_pointless_control_chars(s, m_language.Direction())));
 }
 
@@ -831,6 +839,8 @@ void AnyTranslatableTextCtrl::DoSetValue(const wxString& value, int flags)
 #ifdef __WXMSW__
     wxWindowUpdateLocker dis(this);
 #endif
+    // replacing the text drops existing styling, nothing to update incrementally:
+    InvalidateHighlighting();
     CustomizedTextCtrl::DoSetValue(value, flags);
 #ifdef __WXMSW__
     UpdateRTLStyle();
@@ -859,8 +869,113 @@ void AnyTranslatableTextCtrl::UpdateRTLStyle()
 }
 #endif // !__WXMSW__
 
+namespace
+{
+
+// Finds the span of the text that must be restyled after it changed from
+// @a oldText to @a text.
+//
+// Running the highlighter over the whole string is cheap, what's expensive is
+// restyling the native control, so the comparison is done on the produced
+// ranges: text before the edit and after it (shifted by the length difference)
+// keeps its styling unless its ranges differ between the two runs.
+//
+// The edit location isn't known, it's inferred from common prefix and suffix.
+// Where that's ambiguous, the edited region is widened to cover all possible
+// locations, because text that was physically replaced may have lost its style
+// even if it reads the same. @a caret (if >= 0) is the insertion point after
+// the edit, i.e. right after any typed text.
+template<typename Range>
+std::pair<int, int> FindChangedSpan(const std::wstring& oldText, const std::vector<Range>& oldRanges,
+                                    const std::wstring& text, const std::vector<Range>& ranges,
+                                    int caret)
+{
+    const int oldLen = (int)oldText.length();
+    const int newLen = (int)text.length();
+    const int maxCommon = std::min(oldLen, newLen);
+
+    int prefix = 0;
+    while (prefix < maxCommon && oldText[prefix] == text[prefix])
+        prefix++;
+    int suffix = 0;
+    while (suffix < maxCommon - prefix && oldText[oldLen - suffix - 1] == text[newLen - suffix - 1])
+        suffix++;
+
+    // Insertion or deletion in repetitive text (e.g. typing "a" into "aaa")
+    // could have happened anywhere in the run:
+    if (oldLen != newLen && prefix + suffix == maxCommon)
+    {
+        auto& longer = oldLen > newLen ? oldText : text;
+        const int d = std::abs(newLen - oldLen);
+        while (prefix > 0 && longer[prefix - 1] == longer[prefix - 1 + d])
+            prefix--;
+    }
+
+    // Typing over a selection with the same character doesn't show in the diff:
+    if (caret >= 0 && caret <= newLen)
+    {
+        prefix = std::min(prefix, std::max(caret - 1, 0));
+        suffix = std::min(suffix, newLen - caret);
+    }
+
+    const int delta = newLen - oldLen;
+    const int oldEditEnd = oldLen - suffix;
+    const int newEditEnd = newLen - suffix;
+
+    // The edited text itself is always restyled, because newly inserted text
+    // may have inherited the style of its neighbours:
+    int from = prefix;
+    int to = newEditEnd;
+
+    // Map old ranges to their new positions. Ranges touched by the edit can't be
+    // mapped; they are treated as removed and whatever is left of them restyled.
+    std::vector<Range> mapped;
+    mapped.reserve(oldRanges.size());
+    for (auto& r: oldRanges)
+    {
+        if (r.end <= prefix)
+        {
+            mapped.push_back(r);
+        }
+        else if (r.start >= oldEditEnd)
+        {
+            mapped.push_back({r.start + delta, r.end + delta, r.kind});
+        }
+        else
+        {
+            from = std::min(from, r.start);
+            to = std::max(to, r.end > oldEditEnd ? r.end + delta : newEditEnd);
+        }
+    }
+
+    auto order = [](const Range& a, const Range& b)
+    {
+        return std::tie(a.start, a.end, a.kind) < std::tie(b.start, b.end, b.kind);
+    };
+    std::vector<Range> sorted(ranges);
+    std::sort(sorted.begin(), sorted.end(), order);
+    std::sort(mapped.begin(), mapped.end(), order);
+
+    std::vector<Range> changed;
+    std::set_symmetric_difference(mapped.begin(), mapped.end(),
+                                  sorted.begin(), sorted.end(),
+                                  std::back_inserter(changed), order);
+    for (auto& r: changed)
+    {
+        from = std::min(from, r.start);
+        to = std::max(to, r.end);
+    }
+
+    return {std::max(from, 0), std::min(to, newLen)};
+}
+
+} // anonymous namespace
+
+
 void AnyTranslatableTextCtrl::HighlightText()
 {
+    wxStopWatch sw;
+
 #ifdef __WXOSX__
     // See the comment in DoGetValueForRange() for why GetValue() returns subtly
     // different thing in RTL.
@@ -884,22 +999,55 @@ void AnyTranslatableTextCtrl::HighlightText()
         std::u16string utf16 = boost::locale::conv::utf_to_utf<char16_t>([traw UTF8String]);
         text = std::wstring(utf16.begin(), utf16.end());
     }
+#else
+    auto text = GetValue().ToStdWstring();
+#endif
 
-    NSRange fullRange = NSMakeRange(0, text.length());
-    NSLayoutManager *layout = [TextView(this) layoutManager];
-    [layout removeTemporaryAttribute:NSForegroundColorAttributeName forCharacterRange:fullRange];
-    [layout removeTemporaryAttribute:NSBackgroundColorAttributeName forCharacterRange:fullRange];
-
+    std::vector<HighlightedRange> ranges;
     if (m_syntax)
     {
-        m_syntax->Highlight(text, [=](int a, int b, SyntaxHighlighter::TextKind kind){
-            [layout addTemporaryAttributes:m_attrs->For(kind) forCharacterRange:NSMakeRange(a, b-a)];
+        m_syntax->Highlight(text, [&ranges](int a, int b, SyntaxHighlighter::TextKind kind){
+            ranges.push_back({a, b, kind});
         });
     }
 
-#else // !__WXOSX__
+    int from = 0;
+    int to = (int)text.length();
+    if (m_highlighted.valid)
+    {
+        std::tie(from, to) = FindChangedSpan(m_highlighted.text, m_highlighted.ranges,
+                                             text, ranges, (int)GetInsertionPoint());
+    }
 
-    auto text = GetValue().ToStdWstring();
+    if (from < to)
+        ApplyHighlighting(ranges, from, to);
+
+    wxLogTrace("poedit", "highlighting: restyled [%d,%d) of %d chars in %lld us",
+               from, to, (int)text.length(), (long long)sw.TimeInMicro().GetValue());
+
+    m_highlighted.valid = true;
+    m_highlighted.text = std::move(text);
+    m_highlighted.ranges = std::move(ranges);
+}
+
+
+void AnyTranslatableTextCtrl::ApplyHighlighting(const std::vector<HighlightedRange>& ranges, int from, int to)
+{
+#ifdef __WXOSX__
+    NSRange span = NSMakeRange(from, to - from);
+    NSLayoutManager *layout = [TextView(this) layoutManager];
+    [layout removeTemporaryAttribute:NSForegroundColorAttributeName forCharacterRange:span];
+    [layout removeTemporaryAttribute:NSBackgroundColorAttributeName forCharacterRange:span];
+
+    for (auto& r: ranges)
+    {
+        const int a = std::max(r.start, from);
+        const int b = std::min(r.end, to);
+        if (a < b)
+            [layout addTemporaryAttributes:m_attrs->For(r.kind) forCharacterRange:NSMakeRange(a, b-a)];
+    }
+
+#else // !__WXOSX__
 
     wxEventBlocker block(this, wxEVT_TEXT);
 
@@ -914,25 +1062,27 @@ void AnyTranslatableTextCtrl::HighlightText()
     {
         // If possible, use TOM interface to apply temporary styles, which is much
         // more efficient. Unfortunately, it's not possible to do with read-only controls.
-        SetTOMTmpStyle(doc, 0, text.length(), deflt);
+        SetTOMTmpStyle(doc, from, to, deflt);
 
-        if (m_syntax)
+        for (auto& r: ranges)
         {
-            m_syntax->Highlight(text, [=](int a, int b, SyntaxHighlighter::TextKind kind){
-                SetTOMTmpStyle(doc, a, b, m_attrs->For(kind));
-            });
+            const int a = std::max(r.start, from);
+            const int b = std::min(r.end, to);
+            if (a < b)
+                SetTOMTmpStyle(doc, a, b, m_attrs->For(r.kind));
         }
     }
     else
   #endif // __WXMSW___
     {
-        SetStyle(0, text.length(), deflt);
+        SetStyle(from, to, deflt);
 
-        if (m_syntax)
+        for (auto& r: ranges)
         {
-            m_syntax->Highlight(text, [=](int a, int b, SyntaxHighlighter::TextKind kind){
-                SetStyle(a, b, m_attrs->For(kind));
-            });
+            const int a = std::max(r.start, from);
+            const int b = std::min(r.end, to);
+            if (a < b)
+                SetStyle(a, b, m_attrs->For(r.kind));
         }
     }
 #endif // __WXOSX__/!__WXOSX__
@@ -1020,6 +1170,7 @@ void TranslationTextCtrl::SetPlainTextUserWritten(const wxString& value)
     DisableAutomaticSubstitutions disableAuto(this);
 #endif
 
+    InvalidateHighlighting();
     SelectAll();
     WriteText(EscapePlainText(value));
     SetInsertionPointEnd();
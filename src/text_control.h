@@ -28,6 +28,7 @@
 
 #include <wx/textctrl.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "language.h"
@@ -135,12 +136,36 @@ protected:
 #endif // __WXMSW__
 
 protected:
+    // Updates syntax highlighting after the text changed. Only the part of the
+    // text whose highlighting differs from the previous call is restyled.
     void HighlightText();
 
+    // Forces the next HighlightText() call to restyle the entire text, e.g.
+    // because the text was replaced or the attributes changed.
+    void InvalidateHighlighting() { m_highlighted.valid = false; }
+
+    struct HighlightedRange
+    {
+        int start, end;
+        SyntaxHighlighter::TextKind kind;
+    };
+
+    // Resets [from,to) to the default style and applies those parts of
+    // @a ranges that fall into it.
+    void ApplyHighlighting(const std::vector<HighlightedRange>& ranges, int from, int to);
+
     class Attributes;
     SyntaxHighlighterPtr m_syntax;
     std::unique_ptr<Attributes> m_attrs;
     Language m_language;
+
+    // Text and highlighted ranges as last applied to the control:
+    struct
+    {
+        bool valid = false;
+        std::wstring text;
+        std::vector<HighlightedRange> ranges;
+    } m_highlighted;
 };
 
 
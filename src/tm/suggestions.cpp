@@ -28,10 +28,234 @@
 #include "concurrency.h"
 #include "transmem.h"
 
+#include <wx/log.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <thread>
+
+
+struct SuggestionsBackendRegistry::Stats
+{
+    std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> counts = {};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> errors{0};
+
+    void RecordLatency(std::chrono::steady_clock::duration d)
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+        int bucket = 0;
+        while (ms > 0 && bucket < LatencyHistogram::BUCKETS - 1)
+        {
+            ms >>= 1;
+            bucket++;
+        }
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram Snapshot() const
+    {
+        LatencyHistogram h;
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++)
+            h.counts[i] = counts[i].load(std::memory_order_relaxed);
+        h.timeouts = timeouts.load(std::memory_order_relaxed);
+        h.errors = errors.load(std::memory_order_relaxed);
+        return h;
+    }
+};
+
+
+struct SuggestionsBackendRegistry::Entry
+{
+    std::string name;
+    std::shared_ptr<SuggestionsBackend> backend;
+    std::chrono::milliseconds deadline;
+    std::shared_ptr<Stats> stats;
+};
+
+
+/**
+    Fires callbacks at given time, from a single dedicated thread.
+
+    Used to enforce backends' deadlines without blocking worker threads
+    from the shared pool while waiting for slow backends.
+ */
+class SuggestionsBackendRegistry::DeadlineWatchdog
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    DeadlineWatchdog() : m_stop(false)
+    {
+        m_thread = std::thread([this]{ Run(); });
+    }
+
+    ~DeadlineWatchdog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    void Schedule(clock::time_point when, std::function<void()>&& f)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push(Task{when, std::move(f)});
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    struct Task
+    {
+        clock::time_point when;
+        std::function<void()> func;
+
+        bool operator>(const Task& other) const { return when > other.when; }
+    };
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop)
+        {
+            if (m_queue.empty())
+            {
+                m_cv.wait(lock);
+                continue;
+            }
+
+            auto when = m_queue.top().when;
+            if (clock::now() < when)
+            {
+                m_cv.wait_until(lock, when);
+                continue;
+            }
+
+            auto func = std::move(const_cast<Task&>(m_queue.top()).func);
+            m_queue.pop();
+            lock.unlock();
+            func();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::priority_queue<Task, std::vector<Task>, std::greater<Task>> m_queue;
+    bool m_stop;
+    std::thread m_thread;
+};
+
+
+SuggestionsBackendRegistry *SuggestionsBackendRegistry::ms_instance = nullptr;
+
+static std::once_flag registryInitializationFlag;
+
+SuggestionsBackendRegistry& SuggestionsBackendRegistry::Get()
+{
+    std::call_once(registryInitializationFlag, []() {
+        ms_instance = new SuggestionsBackendRegistry;
+    });
+    return *ms_instance;
+}
+
+void SuggestionsBackendRegistry::CleanUp()
+{
+    if (ms_instance)
+    {
+        delete ms_instance;
+        ms_instance = nullptr;
+    }
+}
+
+SuggestionsBackendRegistry::SuggestionsBackendRegistry()
+    : m_localStats(std::make_shared<Stats>()),
+      m_watchdog(new DeadlineWatchdog)
+{
+}
+
+SuggestionsBackendRegistry::~SuggestionsBackendRegistry()
+{
+}
+
+void SuggestionsBackendRegistry::Register(const std::string& name,
+                                          std::shared_ptr<SuggestionsBackend> backend,
+                                          std::chrono::milliseconds deadline)
+{
+    wxCHECK_RET( !name.empty(), "backend must have a name" );
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& e: m_backends)
+    {
+        if (e.name == name)
+        {
+            e.backend = backend;
+            e.deadline = deadline;
+            return;
+        }
+    }
+    m_backends.push_back(Entry{name, backend, deadline, std::make_shared<Stats>()});
+}
+
+void SuggestionsBackendRegistry::Unregister(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_backends.erase(std::remove_if(m_backends.begin(), m_backends.end(),
+                                    [&name](const Entry& e){ return e.name == name; }),
+                     m_backends.end());
+}
+
+std::shared_ptr<SuggestionsBackend> SuggestionsBackendRegistry::Find(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& e: m_backends)
+    {
+        if (e.name == name)
+            return e.backend;
+    }
+    return nullptr;
+}
+
+std::vector<SuggestionsBackendRegistry::Entry> SuggestionsBackendRegistry::GetAll() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_backends;
+}
+
+std::shared_ptr<SuggestionsBackendRegistry::Stats> SuggestionsBackendRegistry::GetStats(const std::string& name) const
+{
+    if (name.empty())
+        return m_localStats;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& e: m_backends)
+    {
+        if (e.name == name)
+            return e.stats;
+    }
+    return nullptr;
+}
+
+SuggestionsBackendRegistry::LatencyHistogram SuggestionsBackendRegistry::GetLatencyHistogram(const std::string& name) const
+{
+    auto stats = GetStats(name);
+    return stats ? stats->Snapshot() : LatencyHistogram();
+}
+
+
 
 class SuggestionsProviderImpl
 {
 public:
+    typedef std::chrono::steady_clock clock;
+
     SuggestionsProviderImpl() {}
 
     dispatch::future<SuggestionsList> SuggestTranslation(SuggestionsBackend& backend, const SuggestionQuery&& q)
@@ -48,6 +272,101 @@ public:
             return bck->SuggestTranslation(std::move(q));
         });
     }
+
+    std::vector<BackendQuery> SuggestTranslationFromAll(const SuggestionQuery& q)
+    {
+        auto& registry = SuggestionsBackendRegistry::Get();
+        std::vector<BackendQuery> queries;
+
+        // local TM goes first and is never cut off:
+        std::shared_ptr<SuggestionsBackend> tm(&TranslationMemory::Get(), [](SuggestionsBackend*){});
+        queries.push_back({"", tm, Timed(SuggestTranslation(*tm, SuggestionQuery(q)), "", registry.m_localStats)});
+
+        for (auto& e: registry.GetAll())
+        {
+            auto result = Timed(SuggestTranslation(*e.backend, SuggestionQuery(q)), e.name, e.stats);
+            queries.push_back({e.name, e.backend, WithDeadline(std::move(result), e, *registry.m_watchdog)});
+        }
+
+        return queries;
+    }
+
+private:
+    // Records the backend's response time and tags its suggestions with its name
+    static dispatch::future<SuggestionsList> Timed(dispatch::future<SuggestionsList>&& f,
+                                                  const std::string& name,
+                                                  std::shared_ptr<SuggestionsBackendRegistry::Stats> stats)
+    {
+        auto start = clock::now();
+        return f.then([=](dispatch::future<SuggestionsList> r)
+        {
+            try
+            {
+                auto hits = r.get();
+                auto elapsed = clock::now() - start;
+                stats->RecordLatency(elapsed);
+                wxLogTrace("poedit.suggestions", "backend '%s' returned %d hits in %d ms",
+                           name.empty() ? "local TM" : name.c_str(), (int)hits.size(),
+                           (int)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+                if (!name.empty())
+                {
+                    for (auto& h: hits)
+                    {
+                        h.source = Suggestion::Source::Registered;
+                        h.backendName = name;
+                    }
+                }
+                return hits;
+            }
+            catch (...)
+            {
+                stats->errors.fetch_add(1, std::memory_order_relaxed);
+                throw;
+            }
+        });
+    }
+
+    // Completes with an empty list if the backend doesn't respond in time
+    static dispatch::future<SuggestionsList> WithDeadline(dispatch::future<SuggestionsList>&& f,
+                                                         const SuggestionsBackendRegistry::Entry& backend,
+                                                         SuggestionsBackendRegistry::DeadlineWatchdog& watchdog)
+    {
+        struct race
+        {
+            dispatch::promise<SuggestionsList> promise;
+            std::atomic<bool> done{false};
+        };
+        auto state = std::make_shared<race>();
+        dispatch::future<SuggestionsList> result(state->promise.get_future());
+
+        f.then([state](dispatch::future<SuggestionsList> r)
+        {
+            try
+            {
+                auto hits = r.get();
+                if (!state->done.exchange(true))
+                    state->promise.set_value(std::move(hits));
+            }
+            catch (...)
+            {
+                if (!state->done.exchange(true))
+                    dispatch::set_current_exception(state->promise);
+            }
+        });
+
+        auto name = backend.name;
+        auto stats = backend.stats;
+        watchdog.Schedule(clock::now() + backend.deadline, [state, name, stats]
+        {
+            if (state->done.exchange(true))
+                return;
+            stats->timeouts.fetch_add(1, std::memory_order_relaxed);
+            wxLogTrace("poedit.suggestions", "backend '%s' missed its deadline", name.c_str());
+            state->promise.set_value(SuggestionsList());
+        });
+
+        return result;
+    }
 };
 
 
@@ -65,6 +384,11 @@ dispatch::future<SuggestionsList> SuggestionsProvider::SuggestTranslation(Sugges
     return m_impl->SuggestTranslation(backend, std::move(q));
 }
 
+std::vector<BackendQuery> SuggestionsProvider::SuggestTranslationFromAll(const SuggestionQuery& q)
+{
+    return m_impl->SuggestTranslationFromAll(q);
+}
+
 void SuggestionsProvider::Delete(const Suggestion& s)
 {
     if (s.id.empty())
@@ -75,5 +399,9 @@ void SuggestionsProvider::Delete(const Suggestion& s)
         case Suggestion::Source::LocalTM:
             TranslationMemory::Get().Delete(s.id);
             break;
+        case Suggestion::Source::Registered:
+            if (auto backend = SuggestionsBackendRegistry::Get().Find(s.backendName))
+                backend->Delete(s.id);
+            break;
     }
 }
@@ -26,9 +26,13 @@
 #ifndef Poedit_suggestions_h
 #define Poedit_suggestions_h
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -56,7 +60,8 @@ struct Suggestion
     /// Possible types of suggestion sources
     enum class Source
     {
-        LocalTM
+        LocalTM,
+        Registered  ///< backend registered with SuggestionsBackendRegistry
     };
 
     /// Ctor
@@ -80,6 +85,9 @@ struct Suggestion
     /// Source of the suggestion
     Source source;
 
+    /// Name of the registered backend it came from (for Source::Registered)
+    std::string backendName;
+
     /// Optional ID of the suggestion, for use with up/downvoting
     std::string id;
 
@@ -97,6 +105,18 @@ inline bool operator<(const Suggestion& a, const Suggestion& b)
 
 typedef std::vector<Suggestion> SuggestionsList;
 
+
+/// Pending query to one of the backends, as returned by SuggestionsProvider::SuggestTranslationFromAll()
+struct BackendQuery
+{
+    /// Backend's name as registered, empty for the local TM
+    std::string name;
+    /// The backend queried
+    std::shared_ptr<SuggestionsBackend> backend;
+    /// Result of the query; completes no later than the backend's deadline
+    dispatch::future<SuggestionsList> result;
+};
+
 /**
     Provides suggestions for translations.
 
@@ -127,6 +147,20 @@ public:
      */
     dispatch::future<SuggestionsList> SuggestTranslation(SuggestionsBackend& backend, const SuggestionQuery&& q);
 
+    /**
+        Query all available backends concurrently.
+
+        The local TM is always queried first and without a deadline; backends
+        registered with SuggestionsBackendRegistry are queried in parallel with
+        it and their results are cut off (as an empty list) when they don't
+        respond within their deadline.
+
+        Each of the returned futures completes independently, so that callers
+        can show partial results progressively as they arrive and merge them
+        (SuggestionsList is ordered by operator<).
+     */
+    std::vector<BackendQuery> SuggestTranslationFromAll(const SuggestionQuery& q);
+
     /// Mark a suggestion as good. Called when a suggestion is used.
     static void Delete(const Suggestion& s);
 
@@ -172,4 +206,81 @@ public:
     virtual void Delete(const std::string& id) = 0;
 };
 
+
+/**
+    Registry of secondary suggestions backends.
+
+    Backends registered here (e.g. a read-only shared team TM, per-project
+    glossary or a local HTTP service) are queried by
+    SuggestionsProvider::SuggestTranslationFromAll() in addition to the local
+    TranslationMemory, each with its own deadline.
+
+    The registry also keeps per-backend latency histograms.
+
+    All methods are thread-safe.
+ */
+class SuggestionsBackendRegistry
+{
+public:
+    /// Histogram of response times, with power-of-two milliseconds buckets
+    struct LatencyHistogram
+    {
+        /// Number of buckets; bucket i counts responses in [2^(i-1), 2^i) ms
+        /// (bucket 0 is <1ms), the last one everything slower.
+        static const int BUCKETS = 14;
+
+        std::array<uint64_t, BUCKETS> counts = {};
+        /// Number of queries cut off by the deadline
+        uint64_t timeouts = 0;
+        /// Number of failed queries
+        uint64_t errors = 0;
+    };
+
+    /// Return singleton instance of the registry.
+    static SuggestionsBackendRegistry& Get();
+
+    /// Destroys the singleton, must be called (only) on app shutdown.
+    static void CleanUp();
+
+    /**
+        Registers a backend under given (unique) name.
+
+        Results not delivered within @a deadline are ignored; already
+        registered backend with the same name is replaced.
+     */
+    void Register(const std::string& name,
+                  std::shared_ptr<SuggestionsBackend> backend,
+                  std::chrono::milliseconds deadline = std::chrono::milliseconds(500));
+
+    /// Removes backend registered under @a name, if any.
+    void Unregister(const std::string& name);
+
+    /// Returns backend registered under @a name or nullptr.
+    std::shared_ptr<SuggestionsBackend> Find(const std::string& name) const;
+
+    /// Returns latency statistics for the backend (empty string = local TM).
+    LatencyHistogram GetLatencyHistogram(const std::string& name) const;
+
+private:
+    SuggestionsBackendRegistry();
+    ~SuggestionsBackendRegistry();
+
+    struct Stats;
+    struct Entry;
+
+    std::vector<Entry> GetAll() const;
+    std::shared_ptr<Stats> GetStats(const std::string& name) const;
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_backends;
+    std::shared_ptr<Stats> m_localStats;
+
+    class DeadlineWatchdog;
+    std::unique_ptr<DeadlineWatchdog> m_watchdog;
+
+    static SuggestionsBackendRegistry *ms_instance;
+
+    friend class SuggestionsProviderImpl;
+};
+
 #endif // Poedit_suggestions_h
@@ -57,6 +57,24 @@ Collator::~Collator()
         ucol_close(m_coll);
 }
 
+size_t Collator::append_sort_key(const UChar *s, int32_t len, std::vector<uint8_t>& out) const
+{
+    const size_t pos = out.size();
+
+    // keys are usually not much longer than the input, so try to get it in one go:
+    int32_t capacity = 2 * (len >= 0 ? len : u_strlen(s)) + 16;
+    out.resize(pos + capacity);
+    int32_t keylen = ucol_getSortKey(m_coll, s, len, out.data() + pos, capacity);
+    if (keylen > capacity)
+    {
+        out.resize(pos + keylen);
+        keylen = ucol_getSortKey(m_coll, s, len, out.data() + pos, keylen);
+    }
+
+    out.resize(pos + keylen);
+    return keylen;
+}
+
 
 BreakIterator::BreakIterator(UBreakIteratorType type, const Language& lang)
 {
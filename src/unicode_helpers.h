@@ -32,6 +32,8 @@
 
 #include <wx/string.h>
 
+#include <vector>
+
 #include <unicode/ucol.h>
 #include <unicode/ubrk.h>
 
@@ -98,6 +100,17 @@ public:
         return compare(a, b) == UCOL_LESS;
     }
 
+    /**
+        Appends binary sort key for @a s (of @a len UTF-16 units, or
+        NUL-terminated if -1) to @a out.
+
+        Sort keys are NUL-terminated byte strings; comparing them with memcmp()
+        gives the same result as compare() on the original strings, but is
+        much faster when the same string is compared repeatedly.
+        Returns the length of the key, including terminating NUL.
+     */
+    size_t append_sort_key(const UChar *s, int32_t len, std::vector<uint8_t>& out) const;
+
 private:
     UCollator *m_coll = nullptr;
 };